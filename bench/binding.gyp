@@ -0,0 +1,56 @@
+{
+  "targets": [
+    {
+      "target_name": "tci",
+      "sources": [
+        "../tci.cpp",
+        "mock/libtci.cpp"
+      ],
+      "cflags!": [
+        "-fno-exceptions"
+      ],
+      "cflags_cc!": [
+        "-fno-exceptions"
+      ],
+      "cflags_cc": [
+        "-std=c++17"
+      ],
+      "include_dirs": [
+        "<!@(node -p \"require('node-addon-api').include\")",
+        "mock/include"
+      ],
+      "conditions": [
+        [
+          "OS==\"mac\"",
+          {
+            "xcode_settings": {
+              "CLANG_CXX_LANGUAGE_STANDARD": "c++17",
+              "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+              "CLANG_CXX_LIBRARY": "libc++",
+              "MACOSX_DEPLOYMENT_TARGET": "10.15"
+            }
+          }
+        ],
+        [
+          "OS==\"win\"",
+          {
+            "msvs_settings": {
+              "VCCLCompilerTool": {
+                "ExceptionHandling": 1,
+                "AdditionalOptions": [
+                  "-std:c++17"
+                ]
+              }
+            }
+          }
+        ]
+      ]
+    }
+  ],
+  "variables": {
+    "napi_build_version%": "6"
+  },
+  "defines": [
+    "NAPI_VERSION=<(napi_build_version)"
+  ]
+}
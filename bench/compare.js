@@ -0,0 +1,53 @@
+/**
+ * compare two benchmark results of bench/index.js, e.g. of the base and the head commit
+ *
+ * usage: node bench/compare.js <base.json> <head.json> [--threshold <percent>]
+ *
+ * exits with 1 if the throughput of a benchmark dropped by more than threshold percent (default 10)
+ */
+"use strict";
+const fs = require("fs");
+
+const [basePath, headPath, ...options] = process.argv.slice(2);
+if (!basePath || !headPath) {
+  console.error(
+    "usage: node bench/compare.js <base.json> <head.json> [--threshold <percent>]"
+  );
+  process.exit(2);
+}
+const thresholdIndex = options.indexOf("--threshold");
+const threshold =
+  thresholdIndex >= 0 ? Number(options[thresholdIndex + 1]) : 10;
+
+const base = JSON.parse(fs.readFileSync(basePath, "utf8"));
+const head = JSON.parse(fs.readFileSync(headPath, "utf8"));
+const baseResults = new Map(
+  base.results.map((result) => [result.name, result])
+);
+
+console.log(
+  `base ${base.commit} (${base.node}) -> head ${head.commit} (${head.node})`
+);
+let regressions = 0;
+for (const result of head.results) {
+  const before = baseResults.get(result.name);
+  if (!before) {
+    console.log(`${result.name.padEnd(24)} new`);
+    continue;
+  }
+  const change = (result.rowsPerSec / before.rowsPerSec - 1) * 100;
+  const regression = change < -threshold;
+  regressions += regression ? 1 : 0;
+  console.log(
+    [
+      result.name.padEnd(24),
+      `${before.rowsPerSec.toLocaleString()}`.padStart(14),
+      " -> ",
+      `${result.rowsPerSec.toLocaleString()} rows/s`.padEnd(20),
+      `${change >= 0 ? "+" : ""}${change.toFixed(1)}%`.padStart(8),
+      `  heap ${before.heapGrowthMb} -> ${result.heapGrowthMb}MB`,
+      regression ? "  REGRESSION" : "",
+    ].join("")
+  );
+}
+process.exit(regressions ? 1 : 0);
@@ -0,0 +1,350 @@
+/**
+ * driver benchmarks against the mock tci library (bench/mock), no database is required.
+ *
+ * build: npm run bench:build
+ * run:   npm run bench -- [--filter <name>] [--rows <n>] [--iterations <n>] [--out <file>]
+ *
+ * prints a summary to stderr and the results as json to stdout (or --out),
+ * compare the results of two commits with bench/compare.js
+ */
+"use strict";
+process.env.TRANSBASE_BINDING_ROOT = __dirname;
+
+const fs = require("fs");
+const os = require("os");
+const { execSync } = require("child_process");
+const { performance, PerformanceObserver } = require("perf_hooks");
+const { Transbase } = require("../transbase");
+
+const args = parseArgs(process.argv.slice(2));
+const ROWS = Number(args.rows ?? 100000);
+const ITERATIONS = Number(args.iterations ?? 5);
+const LOB_ROWS = 20;
+const LOB_SIZE = 1024 * 1024;
+const POINT_QUERIES = Math.ceil(ROWS / 10);
+
+/** result set shapes served by the mock, @see bench/mock/libtci.cpp */
+const SHAPES = {
+  numbers: "columns=integer,bigint,double,bool",
+  strings: "columns=integer,varchar:32,char:16,varchar:64 nulls=0.1",
+  unicode: "columns=integer,uchar:32,uchar:64",
+  mixed: "columns=integer,double,varchar:32,timestamp,binary:16 nulls=0.1",
+  dates: "columns=integer,timestamp,timestamp",
+};
+
+const select = (shape) => `select rows=${ROWS} ${SHAPES[shape]}`;
+const columnCount = (shape) =>
+  SHAPES[shape].match(/columns=(\S+)/)[1].split(",").length;
+
+const PARAMETERS = [1, 2.5, "some text", null, true, Buffer.alloc(16)];
+const NAMED_PARAMETERS = { a: 1, b: 2.5, c: "some text", d: null, e: true };
+
+const benchmarks = [
+  ...Object.keys(SHAPES).flatMap((shape) => [
+    {
+      name: `next/${shape}`,
+      rows: ROWS,
+      cells: ROWS * columnCount(shape),
+      run: (transbase) => {
+        const resultSet = transbase.query(select(shape));
+        while (resultSet.next());
+      },
+    },
+    {
+      name: `toArray/${shape}`,
+      rows: ROWS,
+      cells: ROWS * columnCount(shape),
+      run: (transbase) => transbase.query(select(shape)).toArray(),
+    },
+  ]),
+  {
+    name: "next/mixed/lazy",
+    rows: ROWS,
+    cells: ROWS * columnCount("mixed"),
+    run: (transbase) => {
+      // reads only two of the columns
+      const resultSet = transbase.query(select("mixed"), [], { lazy: true });
+      for (let row; (row = resultSet.next()); ) {
+        row.integer_1, row.varchar_3;
+      }
+    },
+  },
+  {
+    name: "toArray/mixed/timeout",
+    rows: ROWS,
+    cells: ROWS * columnCount("mixed"),
+    run: (transbase) =>
+      transbase.query(select("mixed"), undefined, { timeout: 60000 }).toArray(),
+  },
+  {
+    name: "toArray/dates/epoch",
+    config: { dateCast: "epoch" },
+    rows: ROWS,
+    cells: ROWS * columnCount("dates"),
+    run: (transbase) => transbase.query(select("dates")).toArray(),
+  },
+  {
+    name: "toArrayAsync/mixed",
+    rows: ROWS,
+    cells: ROWS * columnCount("mixed"),
+    run: async (transbase) =>
+      (await transbase.queryAsync(select("mixed"))).toArrayAsync(),
+  },
+  ...["csv", "ndjson", "arrow"].map((format) => ({
+    name: `exportQuery/${format}`,
+    rows: ROWS,
+    cells: ROWS * columnCount("mixed"),
+    run: (transbase) =>
+      transbase.exportQuery(select("mixed"), undefined, {
+        format,
+        path: os.devnull,
+      }),
+  })),
+  {
+    name: "hashLedgerRecords/mixed",
+    rows: ROWS,
+    cells: ROWS * columnCount("mixed"),
+    run: (transbase) => {
+      const resultSet = transbase.query(select("mixed"));
+      while (resultSet.hashLedgerRecords().length);
+    },
+  },
+  {
+    name: "fetchColumns/mixed",
+    rows: ROWS,
+    cells: ROWS * columnCount("mixed"),
+    run: (transbase) => {
+      const resultSet = transbase.query(select("mixed"));
+      while (resultSet.fetchColumns().length);
+    },
+  },
+  {
+    name: "query/point",
+    rows: POINT_QUERIES,
+    cells: POINT_QUERIES * columnCount("mixed"),
+    run: (transbase) => {
+      const sql = `select rows=1 ${SHAPES.mixed} where id = ?`;
+      for (let i = 0; i < POINT_QUERIES; i++) {
+        transbase.query(sql, [i]).next();
+      }
+    },
+  },
+  {
+    name: "query/point/cached",
+    rows: POINT_QUERIES,
+    cells: POINT_QUERIES * columnCount("mixed"),
+    config: { resultCache: { ttl: 60000 } },
+    run: (transbase) => {
+      const sql = `select rows=1 ${SHAPES.mixed} where id = ?`;
+      for (let i = 0; i < POINT_QUERIES; i++) {
+        transbase.query(sql, [i % 100], { cache: true }).next();
+      }
+    },
+  },
+  {
+    name: "bind/positional",
+    rows: ROWS,
+    cells: ROWS * PARAMETERS.length,
+    run: (transbase) => {
+      const statement = transbase.prepare("insert positional parameters");
+      for (let i = 0; i < ROWS; i++) {
+        PARAMETERS[0] = i;
+        statement.query(PARAMETERS);
+      }
+    },
+  },
+  {
+    name: "bind/named",
+    rows: ROWS,
+    cells: ROWS * Object.keys(NAMED_PARAMETERS).length,
+    run: (transbase) => {
+      const statement = transbase.prepare("insert named parameters");
+      for (let i = 0; i < ROWS; i++) {
+        NAMED_PARAMETERS.a = i;
+        statement.query(NAMED_PARAMETERS);
+      }
+    },
+  },
+  {
+    name: "executeBatch",
+    rows: ROWS,
+    cells: ROWS * (PARAMETERS.length + 1),
+    setup: () => Array.from({ length: ROWS }, (_, i) => [i, ...PARAMETERS]),
+    run: (transbase, rows) => transbase.executeBatch("insert batch", rows),
+  },
+  {
+    name: "executeScript",
+    rows: POINT_QUERIES,
+    setup: () => "insert into script;\n".repeat(POINT_QUERIES),
+    run: (transbase, script) => transbase.executeScript(script),
+  },
+  {
+    name: "lob/readValueAsBuffer",
+    rows: LOB_ROWS,
+    bytes: LOB_ROWS * LOB_SIZE,
+    run: (transbase) => {
+      const resultSet = transbase.query(
+        `select rows=${LOB_ROWS} columns=clob:${LOB_SIZE}`
+      );
+      while (resultSet.fetch()) {
+        while (resultSet.readValueAsBuffer(1).hasMore);
+      }
+    },
+  },
+  {
+    name: "lob/readValueChunks",
+    rows: LOB_ROWS,
+    bytes: LOB_ROWS * LOB_SIZE,
+    run: async (transbase) => {
+      const resultSet = transbase.query(
+        `select rows=${LOB_ROWS} columns=clob:${LOB_SIZE}`
+      );
+      while (resultSet.fetch()) {
+        for await (const _ of resultSet.readValueChunks(1));
+      }
+    },
+  },
+];
+
+/**********************************
+ * MEASUREMENT
+ *********************************/
+const gc = { count: 0, duration: 0 };
+new PerformanceObserver((list) => {
+  for (const entry of list.getEntries()) {
+    gc.count++;
+    gc.duration += entry.duration;
+  }
+}).observe({ entryTypes: ["gc"] });
+
+const flushGcEntries = () => new Promise((resolve) => setImmediate(resolve));
+
+async function measure(benchmark) {
+  const transbase = new Transbase({
+    url: "//mock",
+    user: "mock",
+    password: "",
+    ...benchmark.config,
+  });
+  try {
+    const input = benchmark.setup?.();
+    await benchmark.run(transbase, input); // warm up
+    const samples = [];
+    for (let i = 0; i < ITERATIONS; i++) {
+      await flushGcEntries();
+      const gcBefore = { ...gc };
+      const heapBefore = process.memoryUsage();
+      const start = performance.now();
+      await benchmark.run(transbase, input);
+      const duration = performance.now() - start;
+      const heapAfter = process.memoryUsage();
+      await flushGcEntries();
+      samples.push({
+        duration,
+        gcCount: gc.count - gcBefore.count,
+        gcDuration: gc.duration - gcBefore.duration,
+        heapGrowth:
+          heapAfter.heapUsed -
+          heapBefore.heapUsed +
+          heapAfter.arrayBuffers -
+          heapBefore.arrayBuffers,
+      });
+    }
+    const median = (key) =>
+      samples.map((sample) => sample[key]).sort((a, b) => a - b)[
+        Math.floor(samples.length / 2)
+      ];
+    const duration = median("duration");
+    return {
+      name: benchmark.name,
+      durationMs: round(duration),
+      rowsPerSec: Math.round(benchmark.rows / (duration / 1000)),
+      nsPerCell: benchmark.cells
+        ? round((duration * 1e6) / benchmark.cells)
+        : undefined,
+      mbPerSec: benchmark.bytes
+        ? round(benchmark.bytes / 1024 / 1024 / (duration / 1000))
+        : undefined,
+      gcCount: median("gcCount"),
+      gcMs: round(median("gcDuration")),
+      heapGrowthMb: round(median("heapGrowth") / 1024 / 1024),
+      maxRssMb: round(process.resourceUsage().maxRSS / 1024),
+    };
+  } finally {
+    transbase.close();
+  }
+}
+
+async function main() {
+  const results = [];
+  for (const benchmark of benchmarks) {
+    if (args.filter && !benchmark.name.includes(args.filter)) {
+      continue;
+    }
+    const result = await measure(benchmark);
+    results.push(result);
+    process.stderr.write(format(result) + "\n");
+  }
+  const report = JSON.stringify(
+    {
+      commit: gitCommit(),
+      node: process.version,
+      date: new Date().toISOString(),
+      rows: ROWS,
+      iterations: ITERATIONS,
+      results,
+    },
+    null,
+    2
+  );
+  if (args.out) {
+    fs.writeFileSync(args.out, report);
+  } else {
+    process.stdout.write(report + "\n");
+  }
+}
+
+/**********************************
+ * HELPERS
+ *********************************/
+function parseArgs(argv) {
+  const result = {};
+  for (let i = 0; i < argv.length; i++) {
+    if (argv[i].startsWith("--")) {
+      result[argv[i].slice(2)] = argv[i + 1];
+      i++;
+    }
+  }
+  return result;
+}
+
+function gitCommit() {
+  try {
+    return execSync("git rev-parse --short HEAD", { cwd: __dirname })
+      .toString()
+      .trim();
+  } catch {
+    return undefined;
+  }
+}
+
+function round(value) {
+  return Math.round(value * 100) / 100;
+}
+
+function format(result) {
+  return [
+    result.name.padEnd(24),
+    `${result.rowsPerSec.toLocaleString()} rows/s`.padStart(18),
+    result.nsPerCell != null ? `${result.nsPerCell} ns/cell`.padStart(16) : "",
+    result.mbPerSec != null ? `${result.mbPerSec} MB/s`.padStart(16) : "",
+    `gc ${result.gcCount}x ${result.gcMs}ms`.padStart(18),
+    `heap +${result.heapGrowthMb}MB`.padStart(16),
+    `rss ${result.maxRssMb}MB`.padStart(12),
+  ].join("");
+}
+
+main().catch((error) => {
+  console.error(error);
+  process.exit(1);
+});
@@ -0,0 +1,190 @@
+/*
+ * tci.h of the benchmark mock library.
+ * declares the subset of the transbase call interface used by tci.cpp,
+ * implemented by libtci.cpp with synthetic result sets instead of a database.
+ */
+#ifndef TCI_MOCK_H
+#define TCI_MOCK_H
+
+typedef char Char;
+typedef signed char Int1;
+typedef short Int2;
+typedef int Int4;
+typedef long long Int8;
+typedef unsigned char Uint1;
+typedef unsigned short Uint2;
+typedef unsigned int Uint4;
+
+typedef Int4 TCIState;
+typedef Int4 TBErrorCode;
+typedef Uint2 TCIColumnnumber;
+
+typedef struct TCIEnvironment_s TCIEnvironment;
+typedef struct TCIError_s TCIError;
+typedef struct TCIConnection_s TCIConnection;
+typedef struct TCITransaction_s TCITransaction;
+typedef struct TCIStatement_s TCIStatement;
+typedef struct TCIResultSet_s TCIResultSet;
+
+typedef struct
+{
+	Int4 major_version;
+	Int4 minor_version;
+	Int4 release;
+	Int4 patch;
+	Int4 build;
+} TCIVersion;
+
+#define MAXIDENTSIZE 128
+
+#define TCI_SUCCESS 0
+#define TCI_DATA_TRUNCATION 1
+#define TCI_NO_DATA_FOUND 100
+#define TCI_ERROR -1
+
+#define TCI_FETCH_NEXT 1
+
+#define TCI_ATTR_COLUMN_COUNT 1
+#define TCI_ATTR_COLUMN_NAME 2
+#define TCI_ATTR_COLUMN_TYPE 3
+#define TCI_ATTR_RECORDS_TOUCHED 4
+#define TCI_ATTR_QUERY_TYPE 5
+#define TCI_ATTR_VERSION 6
+
+#define TCI_C_INT1 1
+#define TCI_C_INT2 2
+#define TCI_C_INT4 3
+#define TCI_C_INT8 4
+#define TCI_C_FLOAT 5
+#define TCI_C_DOUBLE 6
+#define TCI_C_CHAR 7
+#define TCI_C_BYTE 8
+
+#define TCI_QUERY_SELECT 1
+#define TCI_QUERY_UPDATE 2
+#define TCI_QUERY_DDL 3
+#define sel_class(q) ((q) == TCI_QUERY_SELECT)
+#define upd_class(q) ((q) == TCI_QUERY_UPDATE)
+#define ddl_class(q) ((q) == TCI_QUERY_DDL)
+
+enum TCISqlType
+{
+	TCI_SQL_BOOL = 1,
+	TCI_SQL_TINYINT,
+	TCI_SQL_SMALLINT,
+	TCI_SQL_INTEGER,
+	TCI_SQL_NUMERIC,
+	TCI_SQL_FLOAT,
+	TCI_SQL_DOUBLE,
+	TCI_SQL_CHAR,
+	TCI_SQL_VARCHAR,
+	TCI_SQL_BINARY,
+	TCI_SQL_BIT,
+	TCI_SQL_BLOB,
+	TCI_SQL_BITSHORT,
+	TCI_SQL_BIGINT,
+	TCI_SQL_CLOB,
+	TCI_SQL_DATE,
+	TCI_SQL_DATE_YEAR,
+	TCI_SQL_DATE_YEAR_TO_MONTH,
+	TCI_SQL_DATE_YEAR_TO_DAY,
+	TCI_SQL_DATE_YEAR_TO_HOUR,
+	TCI_SQL_DATE_YEAR_TO_MINUTE,
+	TCI_SQL_DATE_YEAR_TO_SECOND,
+	TCI_SQL_DATE_YEAR_TO_MILLISECOND,
+	TCI_SQL_DATE_MONTH,
+	TCI_SQL_DATE_MONTH_TO_DAY,
+	TCI_SQL_DATE_MONTH_TO_HOUR,
+	TCI_SQL_DATE_MONTH_TO_MINUTE,
+	TCI_SQL_DATE_MONTH_TO_SECOND,
+	TCI_SQL_DATE_MONTH_TO_MILLISECOND,
+	TCI_SQL_DATE_DAY,
+	TCI_SQL_DATE_DAY_TO_HOUR,
+	TCI_SQL_DATE_DAY_TO_MINUTE,
+	TCI_SQL_DATE_DAY_TO_SECOND,
+	TCI_SQL_DATE_DAY_TO_MILLISECOND,
+	TCI_SQL_DATE_HOUR,
+	TCI_SQL_DATE_HOUR_TO_MINUTE,
+	TCI_SQL_DATE_HOUR_TO_SECOND,
+	TCI_SQL_DATE_HOUR_TO_MILLISECOND,
+	TCI_SQL_DATE_MINUTE,
+	TCI_SQL_DATE_MINUTE_TO_SECOND,
+	TCI_SQL_DATE_MINUTE_TO_MILLISECOND,
+	TCI_SQL_DATE_SECOND,
+	TCI_SQL_DATE_SECOND_TO_MILLISECOND,
+	TCI_SQL_DATE_MILLISECOND,
+	TCI_SQL_TIME,
+	TCI_SQL_TIMESTAMP,
+	TCI_SQL_TYPE_INTERVAL,
+	TCI_SQL_INTERVAL_YEAR,
+	TCI_SQL_INTERVAL_YEAR_TO_MONTH,
+	TCI_SQL_INTERVAL_MONTH,
+	TCI_SQL_INTERVAL_DAY,
+	TCI_SQL_INTERVAL_DAY_TO_HOUR,
+	TCI_SQL_INTERVAL_DAY_TO_MINUTE,
+	TCI_SQL_INTERVAL_DAY_TO_SECOND,
+	TCI_SQL_INTERVAL_DAY_TO_MILLISECOND,
+	TCI_SQL_INTERVAL_HOUR,
+	TCI_SQL_INTERVAL_HOUR_TO_MINUTE,
+	TCI_SQL_INTERVAL_HOUR_TO_SECOND,
+	TCI_SQL_INTERVAL_HOUR_TO_MILLISECOND,
+	TCI_SQL_INTERVAL_MINUTE,
+	TCI_SQL_INTERVAL_MINUTE_TO_SECOND,
+	TCI_SQL_INTERVAL_MINUTE_TO_MILLISECOND,
+	TCI_SQL_INTERVAL_SECOND,
+	TCI_SQL_INTERVAL_SECOND_TO_MILLISECOND,
+	TCI_SQL_INTERVAL_MILLISECOND
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+	TCIState TCIAllocEnvironment(TCIEnvironment **environment);
+	TCIState TCIFreeEnvironment(TCIEnvironment *environment);
+	TCIState TCIGetEnvironmentError(TCIEnvironment *environment, Int4 recordNumber, Char *message, Int4 size, TBErrorCode *code, Char *sqlcode);
+	TCIState TCIGetEnvironmentAttribute(TCIEnvironment *environment, Int4 attribute, Int4 recordNumber, void *value, Int4 size, Int4 *length);
+
+	TCIState TCIAllocError(TCIEnvironment *environment, TCIError **error);
+	TCIState TCIFreeError(TCIError *error);
+	TCIState TCIGetError(TCIError *error, Int4 recordNumber, Int4 level, Char *message, Int4 size, TBErrorCode *code, Char *sqlcode);
+
+	TCIState TCIAllocConnection(TCIEnvironment *environment, TCIError *error, TCIConnection **connection);
+	TCIState TCIFreeConnection(TCIConnection *connection);
+	TCIState TCIConnect(TCIConnection *connection, Char *url);
+	TCIState TCIDisconnect(TCIConnection *connection);
+	TCIState TCILogin(TCIConnection *connection, Char *user, Char *password);
+	TCIState TCILogout(TCIConnection *connection);
+	TCIState TCIGetConnectionAttribute(TCIConnection *connection, Int4 attribute, Int4 recordNumber, void *value, Int4 size, Int4 *length);
+
+	TCIState TCIAllocTransaction(TCIEnvironment *environment, TCIError *error, TCITransaction **transaction);
+	TCIState TCIFreeTransaction(TCITransaction *transaction);
+	TCIState TCIBeginTransaction(TCITransaction *transaction, TCIConnection *connection);
+	TCIState TCICommitTransaction(TCITransaction *transaction);
+	TCIState TCIRollbackTransaction(TCITransaction *transaction);
+
+	TCIState TCIAllocStatement(TCIConnection *connection, TCIError *error, TCIStatement **statement);
+	TCIState TCIFreeStatement(TCIStatement *statement);
+	TCIState TCIPrepare(TCIStatement *statement, Char *query);
+
+	TCIState TCIAllocResultSet(TCIStatement *statement, TCIError *error, TCIResultSet **resultSet);
+	TCIState TCIFreeResultSet(TCIResultSet *resultSet);
+	TCIState TCIExecuteDirect(TCIResultSet *resultSet, Char *query, Int4 resultSetType, Int4 flags);
+	TCIState TCIExecute(TCIResultSet *resultSet, Int4 resultSetType, Int4 flags);
+	TCIState TCIFetch(TCIResultSet *resultSet, Int4 count, Int2 scrollMode, Int4 offset);
+	TCIState TCIClose(TCIResultSet *resultSet);
+	TCIState TCICancel(TCIResultSet *resultSet);
+	TCIState TCIGetResultSetAttribute(TCIResultSet *resultSet, Int4 attribute, TCIColumnnumber column, void *value, Int4 size, Int4 *length);
+
+	TCIState TCIGetData(TCIResultSet *resultSet, TCIColumnnumber column, void *data, Int4 size, Int4 *byteSize, Int2 type, Int2 *isNull);
+	TCIState TCIGetDataSize(TCIResultSet *resultSet, TCIColumnnumber column, Int2 type, Int4 *byteSize, Int2 *isNull);
+	TCIState TCIGetDataCharLength(TCIResultSet *resultSet, TCIColumnnumber column, Int4 *charLength, Int2 *isNull);
+	TCIState TCISetData(TCIResultSet *resultSet, TCIColumnnumber column, void *data, Int4 size, Int2 type, Int2 *isNull);
+	TCIState TCISetDataByName(TCIResultSet *resultSet, Char *name, void *data, Int4 size, Int2 type, Int2 *isNull);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,597 @@
+/*
+ * mock of the transbase call interface for benchmarks.
+ * serves synthetic result sets, whose shape is described by the query text, e.g.
+ *
+ *   select rows=100000 columns=integer,double,varchar:32,clob:65536 nulls=0.1
+ *
+ * columns are "<type>[:<length>]" of bool, tinyint, smallint, integer, bigint, float, double, numeric,
+ * char, varchar, clob (ascii text), uchar (text with 2 byte utf-8 characters), binary, blob, timestamp.
+ * every other statement (e.g. an insert) touches one record and accepts any parameters.
+ * queries containing "error" fail with sqlcode 42000.
+ */
+#include "tci.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <sstream>
+#include <cstring>
+#include <cstdio>
+#include <cstdint>
+#include <cctype>
+#include <algorithm>
+
+struct TCIEnvironment_s
+{
+};
+
+struct TCIError_s
+{
+	std::string message;
+	TBErrorCode code = 0;
+};
+
+struct TCIConnection_s
+{
+	TCIError *error = NULL;
+};
+
+struct TCITransaction_s
+{
+	bool active = false;
+};
+
+namespace
+{
+	struct Column
+	{
+		std::string name;
+		int type = 0;
+		Int4 length = 0;
+	};
+
+	struct Query
+	{
+		bool select = false;
+		bool error = false;
+		Int8 rows = 0;
+		double nulls = 0;
+		std::vector<Column> columns;
+	};
+
+	const struct
+	{
+		const char *name;
+		int type;
+		Int4 length;
+	} TYPES[] = {
+		{"bool", TCI_SQL_BOOL, 0},
+		{"tinyint", TCI_SQL_TINYINT, 0},
+		{"smallint", TCI_SQL_SMALLINT, 0},
+		{"integer", TCI_SQL_INTEGER, 0},
+		{"bigint", TCI_SQL_BIGINT, 0},
+		{"float", TCI_SQL_FLOAT, 0},
+		{"double", TCI_SQL_DOUBLE, 0},
+		{"numeric", TCI_SQL_NUMERIC, 0},
+		{"char", TCI_SQL_CHAR, 16},
+		{"varchar", TCI_SQL_VARCHAR, 32},
+		{"uchar", TCI_SQL_VARCHAR, 32},
+		{"clob", TCI_SQL_CLOB, 65536},
+		{"binary", TCI_SQL_BINARY, 16},
+		{"blob", TCI_SQL_BLOB, 65536},
+		{"timestamp", TCI_SQL_TIMESTAMP, 0},
+	};
+
+	Query parse(const char *sql)
+	{
+		Query query;
+		std::istringstream tokens(sql);
+		std::string token;
+		tokens >> token;
+		std::transform(token.begin(), token.end(), token.begin(), ::tolower);
+		query.select = token == "select";
+		query.error = strstr(sql, "error") != NULL;
+		while (tokens >> token)
+		{
+			auto separator = token.find('=');
+			if (separator == std::string::npos)
+				continue;
+			auto key = token.substr(0, separator);
+			auto value = token.substr(separator + 1);
+			if (key == "rows")
+				query.rows = std::stoll(value);
+			else if (key == "nulls")
+				query.nulls = std::stod(value);
+			else if (key == "columns")
+			{
+				std::istringstream specs(value);
+				std::string spec;
+				while (std::getline(specs, spec, ','))
+				{
+					auto colon = spec.find(':');
+					auto typeName = spec.substr(0, colon);
+					for (auto &type : TYPES)
+					{
+						if (typeName != type.name)
+							continue;
+						auto length = colon == std::string::npos ? type.length : std::stoi(spec.substr(colon + 1));
+						query.columns.push_back({typeName + "_" + std::to_string(query.columns.size() + 1), type.type, length});
+					}
+				}
+			}
+		}
+		return query;
+	}
+}
+
+struct TCIStatement_s
+{
+	TCIError *error = NULL;
+	Query query{};
+};
+
+struct TCIResultSet_s
+{
+	TCIStatement *statement = NULL;
+	TCIError *error = NULL;
+	Query query{};
+	bool open = false;
+	Int8 row = 0; // the current row starting with 1
+	std::vector<size_t> offsets; // of chunked reads in the current row
+	std::unordered_map<std::string, std::string> parameters;
+
+	// the text and raw value of the last accessed cell
+	int cachedColumn = 0;
+	std::string text;
+	std::string raw;
+
+	TCIState fail(const std::string &message)
+	{
+		error->message = message;
+		error->code = 1;
+		return TCI_ERROR;
+	}
+
+	bool isNull(int col)
+	{
+		if (query.nulls <= 0)
+			return false;
+		uint64_t hash = (uint64_t)row * 2654435761u + (uint64_t)col * 40503u;
+		return (hash % 1000) < query.nulls * 1000;
+	}
+
+	double number(const Column &column)
+	{
+		switch (column.type)
+		{
+		case TCI_SQL_BOOL:
+			return row % 2;
+		case TCI_SQL_TINYINT:
+			return row % 128;
+		case TCI_SQL_SMALLINT:
+			return row % 32768;
+		case TCI_SQL_BIGINT:
+			return (double)(row * 1000003);
+		case TCI_SQL_FLOAT:
+		case TCI_SQL_DOUBLE:
+		case TCI_SQL_NUMERIC:
+			return row + 0.25;
+		default:
+			return (double)row;
+		}
+	}
+
+	/** compute the text (TCI_C_CHAR) and raw (TCI_C_BYTE) value of a cell once per row */
+	void load(int col)
+	{
+		if (cachedColumn == col)
+			return;
+		cachedColumn = col;
+		auto &column = query.columns[col - 1];
+		text.clear();
+		raw.clear();
+		switch (column.type)
+		{
+		case TCI_SQL_CHAR:
+		case TCI_SQL_VARCHAR:
+		case TCI_SQL_CLOB:
+		{
+			bool utf8 = column.name.compare(0, 5, "uchar") == 0;
+			for (Int4 i = 0; i < column.length; i++)
+			{
+				if (utf8 && i % 2)
+					text += "\xc3\xa4"; // ä
+				else
+					text += (char)('a' + (row + i) % 26);
+			}
+			raw = text;
+			break;
+		}
+		case TCI_SQL_BINARY:
+		case TCI_SQL_BLOB:
+		{
+			static const char *HEX = "0123456789abcdef";
+			for (Int4 i = 0; i < column.length; i++)
+			{
+				unsigned char byte = (unsigned char)(row + i);
+				raw += (char)byte;
+				text += HEX[byte >> 4];
+				text += HEX[byte & 15];
+			}
+			break;
+		}
+		case TCI_SQL_TIMESTAMP:
+		{
+			char timestamp[32];
+			snprintf(timestamp, sizeof(timestamp), "2024-01-%02d 12:%02d:%02d.%03d", (int)(row % 28) + 1, (int)(row % 60), (int)(row / 60 % 60), (int)(row % 1000));
+			text = raw = timestamp;
+			break;
+		}
+		case TCI_SQL_BOOL:
+			text = raw = row % 2 ? "true" : "false";
+			break;
+		default:
+		{
+			std::ostringstream stream;
+			stream << number(column);
+			text = raw = stream.str();
+		}
+		}
+	}
+
+	/** copy the next chunk of a value, the state is TCI_DATA_TRUNCATION if there is more */
+	TCIState chunk(int col, const std::string &value, void *data, Int4 size, Int4 *byteSize, bool terminate)
+	{
+		auto &offset = offsets[col - 1];
+		auto available = value.size() - std::min(offset, value.size());
+		auto capacity = terminate ? std::max(size - 1, 0) : size;
+		auto length = std::min(available, (size_t)capacity);
+		memcpy(data, value.data() + offset, length);
+		if (terminate && size > 0)
+			((char *)data)[length] = 0;
+		offset += length;
+		if (byteSize)
+			*byteSize = (Int4)length;
+		return length < available ? TCI_DATA_TRUNCATION : TCI_SUCCESS;
+	}
+};
+
+extern "C"
+{
+	TCIState TCIAllocEnvironment(TCIEnvironment **environment)
+	{
+		*environment = new TCIEnvironment();
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCIFreeEnvironment(TCIEnvironment *environment)
+	{
+		delete environment;
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCIGetEnvironmentError(TCIEnvironment *environment, Int4 recordNumber, Char *message, Int4 size, TBErrorCode *code, Char *sqlcode)
+	{
+		snprintf(message, size, "mock environment error");
+		return TCI_SUCCESS;
+	}
+
+	static TCIState getVersion(void *value, Int4 size)
+	{
+		if (size < (Int4)sizeof(TCIVersion))
+			return TCI_ERROR;
+		*(TCIVersion *)value = {8, 4, 1, 0, 0};
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCIGetEnvironmentAttribute(TCIEnvironment *environment, Int4 attribute, Int4 recordNumber, void *value, Int4 size, Int4 *length)
+	{
+		return getVersion(value, size);
+	}
+
+	TCIState TCIAllocError(TCIEnvironment *environment, TCIError **error)
+	{
+		*error = new TCIError();
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCIFreeError(TCIError *error)
+	{
+		delete error;
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCIGetError(TCIError *error, Int4 recordNumber, Int4 level, Char *message, Int4 size, TBErrorCode *code, Char *sqlcode)
+	{
+		snprintf(message, size, "%s", error->message.c_str());
+		if (code)
+			*code = error->code;
+		if (sqlcode)
+			memcpy(sqlcode, "42000", 5);
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCIAllocConnection(TCIEnvironment *environment, TCIError *error, TCIConnection **connection)
+	{
+		*connection = new TCIConnection{error};
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCIFreeConnection(TCIConnection *connection)
+	{
+		delete connection;
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCIConnect(TCIConnection *connection, Char *url)
+	{
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCIDisconnect(TCIConnection *connection)
+	{
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCILogin(TCIConnection *connection, Char *user, Char *password)
+	{
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCILogout(TCIConnection *connection)
+	{
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCIGetConnectionAttribute(TCIConnection *connection, Int4 attribute, Int4 recordNumber, void *value, Int4 size, Int4 *length)
+	{
+		return getVersion(value, size);
+	}
+
+	TCIState TCIAllocTransaction(TCIEnvironment *environment, TCIError *error, TCITransaction **transaction)
+	{
+		*transaction = new TCITransaction();
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCIFreeTransaction(TCITransaction *transaction)
+	{
+		delete transaction;
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCIBeginTransaction(TCITransaction *transaction, TCIConnection *connection)
+	{
+		transaction->active = true;
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCICommitTransaction(TCITransaction *transaction)
+	{
+		transaction->active = false;
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCIRollbackTransaction(TCITransaction *transaction)
+	{
+		transaction->active = false;
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCIAllocStatement(TCIConnection *connection, TCIError *error, TCIStatement **statement)
+	{
+		*statement = new TCIStatement{error};
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCIFreeStatement(TCIStatement *statement)
+	{
+		delete statement;
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCIPrepare(TCIStatement *statement, Char *query)
+	{
+		statement->query = parse(query);
+		if (statement->query.error)
+		{
+			statement->error->message = std::string("mock error: ") + query;
+			return TCI_ERROR;
+		}
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCIAllocResultSet(TCIStatement *statement, TCIError *error, TCIResultSet **resultSet)
+	{
+		*resultSet = new TCIResultSet();
+		(*resultSet)->statement = statement;
+		(*resultSet)->error = error;
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCIFreeResultSet(TCIResultSet *resultSet)
+	{
+		delete resultSet;
+		return TCI_SUCCESS;
+	}
+
+	static TCIState execute(TCIResultSet *resultSet, const Query &query)
+	{
+		if (query.error)
+			return resultSet->fail("mock error");
+		resultSet->query = query;
+		resultSet->open = query.select;
+		resultSet->row = 0;
+		resultSet->cachedColumn = 0;
+		resultSet->offsets.assign(query.columns.size(), 0);
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCIExecuteDirect(TCIResultSet *resultSet, Char *query, Int4 resultSetType, Int4 flags)
+	{
+		return execute(resultSet, parse(query));
+	}
+
+	TCIState TCIExecute(TCIResultSet *resultSet, Int4 resultSetType, Int4 flags)
+	{
+		return execute(resultSet, resultSet->statement->query);
+	}
+
+	TCIState TCIFetch(TCIResultSet *resultSet, Int4 count, Int2 scrollMode, Int4 offset)
+	{
+		if (!resultSet->open)
+			return resultSet->fail("no open result set");
+		if (resultSet->row >= resultSet->query.rows)
+			return TCI_NO_DATA_FOUND;
+		resultSet->row++;
+		resultSet->cachedColumn = 0;
+		std::fill(resultSet->offsets.begin(), resultSet->offsets.end(), 0);
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCIClose(TCIResultSet *resultSet)
+	{
+		resultSet->open = false;
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCICancel(TCIResultSet *resultSet)
+	{
+		resultSet->open = false;
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCIGetResultSetAttribute(TCIResultSet *resultSet, Int4 attribute, TCIColumnnumber column, void *value, Int4 size, Int4 *length)
+	{
+		auto &query = resultSet->query;
+		Int4 number = 0;
+		switch (attribute)
+		{
+		case TCI_ATTR_COLUMN_COUNT:
+			number = (Int4)query.columns.size();
+			break;
+		case TCI_ATTR_COLUMN_TYPE:
+			if (column < 1 || column > query.columns.size())
+				return resultSet->fail("invalid column number");
+			number = query.columns[column - 1].type;
+			break;
+		case TCI_ATTR_COLUMN_NAME:
+			if (column < 1 || column > query.columns.size())
+				return resultSet->fail("invalid column number");
+			snprintf((char *)value, size, "%s", query.columns[column - 1].name.c_str());
+			return TCI_SUCCESS;
+		case TCI_ATTR_RECORDS_TOUCHED:
+			number = query.select ? 0 : 1;
+			break;
+		case TCI_ATTR_QUERY_TYPE:
+			number = query.select ? TCI_QUERY_SELECT : TCI_QUERY_UPDATE;
+			break;
+		default:
+			return resultSet->fail("unsupported attribute");
+		}
+		if (size == sizeof(Uint2))
+			*(Uint2 *)value = (Uint2)number;
+		else
+			*(Int4 *)value = number;
+		return TCI_SUCCESS;
+	}
+
+	static TCIState checkCell(TCIResultSet *resultSet, TCIColumnnumber column, Int2 *isNull)
+	{
+		if (resultSet->row < 1 || resultSet->row > resultSet->query.rows)
+			return resultSet->fail("no current row");
+		if (column < 1 || column > resultSet->query.columns.size())
+			return resultSet->fail("invalid column number");
+		if (isNull)
+			*isNull = resultSet->isNull(column) ? 1 : 0;
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCIGetData(TCIResultSet *resultSet, TCIColumnnumber column, void *data, Int4 size, Int4 *byteSize, Int2 type, Int2 *isNull)
+	{
+		Int2 null = 0;
+		auto state = checkCell(resultSet, column, &null);
+		if (isNull)
+			*isNull = null;
+		if (state || null)
+			return state;
+
+		auto &col = resultSet->query.columns[column - 1];
+		auto number = resultSet->number(col);
+		switch (type)
+		{
+		case TCI_C_INT1:
+			*(Int1 *)data = (Int1)number;
+			break;
+		case TCI_C_INT2:
+			*(Int2 *)data = (Int2)number;
+			break;
+		case TCI_C_INT4:
+			*(Int4 *)data = (Int4)number;
+			break;
+		case TCI_C_INT8:
+			*(Int8 *)data = (Int8)number;
+			break;
+		case TCI_C_FLOAT:
+			*(float *)data = (float)number;
+			break;
+		case TCI_C_DOUBLE:
+			*(double *)data = number;
+			break;
+		case TCI_C_CHAR:
+			resultSet->load(column);
+			return resultSet->chunk(column, resultSet->text, data, size, byteSize, true);
+		case TCI_C_BYTE:
+			resultSet->load(column);
+			return resultSet->chunk(column, resultSet->raw, data, size, byteSize, false);
+		default:
+			return resultSet->fail("unsupported c type");
+		}
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCIGetDataSize(TCIResultSet *resultSet, TCIColumnnumber column, Int2 type, Int4 *byteSize, Int2 *isNull)
+	{
+		auto state = checkCell(resultSet, column, isNull);
+		if (state)
+			return state;
+		resultSet->load(column);
+		*byteSize = (Int4)(type == TCI_C_BYTE ? resultSet->raw.size() : resultSet->text.size());
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCIGetDataCharLength(TCIResultSet *resultSet, TCIColumnnumber column, Int4 *charLength, Int2 *isNull)
+	{
+		auto state = checkCell(resultSet, column, isNull);
+		if (state)
+			return state;
+		resultSet->load(column);
+		*charLength = 0;
+		for (unsigned char c : resultSet->text)
+		{
+			if ((c & 0xc0) != 0x80) // not a utf-8 continuation byte
+				(*charLength)++;
+		}
+		return TCI_SUCCESS;
+	}
+
+	static TCIState setParameter(TCIResultSet *resultSet, const std::string &key, void *data, Int4 size, Int2 *isNull)
+	{
+		// keep a copy like the real library does
+		auto &parameter = resultSet->parameters[key];
+		if (isNull && *isNull)
+			parameter.clear();
+		else
+			parameter.assign((const char *)data, std::max(size, 0));
+		return TCI_SUCCESS;
+	}
+
+	TCIState TCISetData(TCIResultSet *resultSet, TCIColumnnumber column, void *data, Int4 size, Int2 type, Int2 *isNull)
+	{
+		return setParameter(resultSet, std::to_string(column), data, size, isNull);
+	}
+
+	TCIState TCISetDataByName(TCIResultSet *resultSet, Char *name, void *data, Int4 size, Int2 type, Int2 *isNull)
+	{
+		return setParameter(resultSet, name, data, size, isNull);
+	}
+}
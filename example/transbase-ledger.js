@@ -1,7 +1,18 @@
 const crypto = require("crypto");
 
 class TransbaseLedger {
+  /**
+   * hash the records of a result set in batches of maxRows rows natively
+   * @returns an array of record hashes, empty at the end of the result set
+   */
+  static hashLedgerRecords(resultSet, maxRows) {
+    return resultSet.hashLedgerRecords(maxRows);
+  }
+
   static hashLedgerRecord(resultSet) {
+    if (typeof resultSet.hashLedgerRecord === "function") {
+      return resultSet.hashLedgerRecord(); // native, same result
+    }
     const hash = crypto.createHash("sha256");
     hash.update(Buffer.from([0]));
 
@@ -75,8 +86,8 @@ class TransbaseLedger {
 
     res.toArray().forEach((row) => {
       const hash = Buffer.from(row.hash, "hex");
-      hashOld = calcHash(res.old, row.first, hashOld, hash);
-      hashNew = calcHash(res.new, row.first, hashNew, hash);
+      hashOld = calcHash(row.old, row.first, hashOld, hash);
+      hashNew = calcHash(row.new, row.first, hashNew, hash);
     });
 
     return (
@@ -85,6 +96,54 @@ class TransbaseLedger {
     );
   }
 
+  /**
+   * verify many audit proofs, the proof paths are queried one after another
+   * and folded natively on up to `threads` worker threads
+   * @returns the validity of every record
+   */
+  static verifyAuditProofs(
+    transbase,
+    records,
+    { threads, ledger = require("@transaction/transbase-nodejs").Ledger } = {}
+  ) {
+    const proofs = records.map(
+      ({ ledgerHash, ledgerIdx, recordId, recordHash }) => ({
+        recordHash,
+        ledgerHash,
+        path: transbase
+          .query(
+            "select hash, first from ledger_audit_proof(?, ?) order by level asc",
+            [ledgerIdx, recordId],
+            { typeCast: true }
+          )
+          .toArray(),
+      })
+    );
+    return ledger.verifyAuditProofs(proofs, threads);
+  }
+
+  /** verify many consistency proofs, @see verifyAuditProofs */
+  static verifyConsistencyProofs(
+    transbase,
+    ledgers,
+    { threads, ledger = require("@transaction/transbase-nodejs").Ledger } = {}
+  ) {
+    const proofs = ledgers.map(
+      ({ ledgerHashOld, ledgerIdxOld, ledgerHashNew, ledgerIdxNew }) => ({
+        ledgerHashOld,
+        ledgerHashNew,
+        path: transbase
+          .query(
+            "select hash, first, old, new from ledger_consistency_proof(?, ?) order by new asc",
+            [ledgerIdxOld, ledgerIdxNew],
+            { typeCast: true }
+          )
+          .toArray(),
+      })
+    );
+    return ledger.verifyConsistencyProofs(proofs, threads);
+  }
+
   static hashLedgerNodes(first, second) {
     const hash = crypto.createHash("sha256");
     hash.update(Buffer.from([1]));
@@ -4,279 +4,5372 @@
 
 #include <napi.h>
 #include "tci.h"
-#include <variant>
+#include <functional>
+#include <stdexcept>
+#include <memory>
+#include <vector>
+#include <cstring>
+#include <list>
+#include <unordered_map>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <cstdio>
+#include <cerrno>
+#include <cctype>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 typedef char Char;
+
+/** true if all bytes are 7-bit ascii, checked a word at a time */
+static bool isAscii(const char *data, size_t size)
+{
+	size_t i = 0;
+	for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+	{
+		uint64_t word;
+		memcpy(&word, data + i, sizeof(word));
+		if (word & 0x8080808080808080ULL)
+			return false;
+	}
+	for (; i < size; i++)
+	{
+		if (data[i] & 0x80)
+			return false;
+	}
+	return true;
+}
+
+/** js string of utf-8 data, ascii data is created as latin-1 which skips utf-8 decoding */
+static Napi::Value newString(Napi::Env env, const char *data, size_t size)
+{
+	if (!isAscii(data, size))
+		return Napi::String::New(env, data, size);
+	napi_value value;
+	napi_status status = napi_create_string_latin1(env, data, size, &value);
+	NAPI_THROW_IF_FAILED(env, status, Napi::Value());
+	return Napi::Value(env, value);
+}
+
 /**
- * node-api tci wrapper
+ * reuses the js strings of repeated short values (status codes, enum-like columns) within one batch.
+ * a column with too many distinct values stops being interned.
+ * the strings are only valid in the handle scope of the native call that created them.
  */
-class TCI : public Napi::ObjectWrap<TCI>
+struct StringInterner
 {
-private:
-	TCIState state = TCI_SUCCESS;
-	TCIError *error = NULL;
-	TCIEnvironment *environment = NULL;
-	TCIConnection *connection = NULL;
-	TCITransaction *transaction = NULL;
-	TCIStatement *statement = NULL;
-	TCIResultSet *resultSet = NULL;
-	Char sqlcode[5];
-	TBErrorCode errorCode;
-	Char errorMessage[1000];
-	short isNull;
-	Napi::Env env;
-	bool typeCast = true;
+	static const size_t MAX_LENGTH = 32;
+	static const size_t MAX_ENTRIES = 256;
+	std::unordered_map<std::string, Napi::Value> strings;
+	std::string key; // reused lookup key
+	bool full = false;
+
+	Napi::Value get(Napi::Env env, const char *data, size_t size)
+	{
+		if (full || size > MAX_LENGTH)
+			return newString(env, data, size);
+		key.assign(data, size);
+		auto found = strings.find(key);
+		if (found != strings.end())
+			return found->second;
+		auto value = newString(env, data, size);
+		if (strings.size() < MAX_ENTRIES)
+			strings.emplace(key, value);
+		else
+			full = true;
+		return value;
+	}
+};
+
+/**
+ * decodes the character representation of datetime and timespan values to milliseconds natively,
+ * instead of creating js strings that have to be parsed again.
+ */
+struct Temporal
+{
+	/** how datetime and timespan values are returned if typeCast is enabled */
+	enum Cast
+	{
+		STRING, // as formatted by tci
+		DATE,	// js Date for datetimes with a year, milliseconds otherwise
+		EPOCH,	// milliseconds
+	};
+
+	enum Field
+	{
+		YEAR,
+		MONTH,
+		DAY,
+		HOUR,
+		MINUTE,
+		SECOND,
+		MILLISECOND,
+	};
+
+	int type;
+	Field first;
+	Field last;
+	bool interval;
+
+	/** the range of a datetime or timespan type, NULL if values of the type are kept as strings */
+	static const Temporal *of(int sqlType)
+	{
+		// a datetime without year or a day without month has no meaningful number, neither has a month interval
+		static const Temporal TYPES[] = {
+			{TCI_SQL_DATE, YEAR, DAY, false},
+			{TCI_SQL_TIME, HOUR, SECOND, false},
+			{TCI_SQL_TIMESTAMP, YEAR, MILLISECOND, false},
+			{TCI_SQL_DATE_YEAR_TO_DAY, YEAR, DAY, false},
+			{TCI_SQL_DATE_YEAR_TO_HOUR, YEAR, HOUR, false},
+			{TCI_SQL_DATE_YEAR_TO_MINUTE, YEAR, MINUTE, false},
+			{TCI_SQL_DATE_YEAR_TO_SECOND, YEAR, SECOND, false},
+			{TCI_SQL_DATE_YEAR_TO_MILLISECOND, YEAR, MILLISECOND, false},
+			{TCI_SQL_DATE_HOUR, HOUR, HOUR, false},
+			{TCI_SQL_DATE_HOUR_TO_MINUTE, HOUR, MINUTE, false},
+			{TCI_SQL_DATE_HOUR_TO_SECOND, HOUR, SECOND, false},
+			{TCI_SQL_DATE_HOUR_TO_MILLISECOND, HOUR, MILLISECOND, false},
+			{TCI_SQL_DATE_MINUTE, MINUTE, MINUTE, false},
+			{TCI_SQL_DATE_MINUTE_TO_SECOND, MINUTE, SECOND, false},
+			{TCI_SQL_DATE_MINUTE_TO_MILLISECOND, MINUTE, MILLISECOND, false},
+			{TCI_SQL_DATE_SECOND, SECOND, SECOND, false},
+			{TCI_SQL_DATE_SECOND_TO_MILLISECOND, SECOND, MILLISECOND, false},
+			{TCI_SQL_DATE_MILLISECOND, MILLISECOND, MILLISECOND, false},
+			{TCI_SQL_INTERVAL_DAY, DAY, DAY, true},
+			{TCI_SQL_INTERVAL_DAY_TO_HOUR, DAY, HOUR, true},
+			{TCI_SQL_INTERVAL_DAY_TO_MINUTE, DAY, MINUTE, true},
+			{TCI_SQL_INTERVAL_DAY_TO_SECOND, DAY, SECOND, true},
+			{TCI_SQL_INTERVAL_DAY_TO_MILLISECOND, DAY, MILLISECOND, true},
+			{TCI_SQL_INTERVAL_HOUR, HOUR, HOUR, true},
+			{TCI_SQL_INTERVAL_HOUR_TO_MINUTE, HOUR, MINUTE, true},
+			{TCI_SQL_INTERVAL_HOUR_TO_SECOND, HOUR, SECOND, true},
+			{TCI_SQL_INTERVAL_HOUR_TO_MILLISECOND, HOUR, MILLISECOND, true},
+			{TCI_SQL_INTERVAL_MINUTE, MINUTE, MINUTE, true},
+			{TCI_SQL_INTERVAL_MINUTE_TO_SECOND, MINUTE, SECOND, true},
+			{TCI_SQL_INTERVAL_MINUTE_TO_MILLISECOND, MINUTE, MILLISECOND, true},
+			{TCI_SQL_INTERVAL_SECOND, SECOND, SECOND, true},
+			{TCI_SQL_INTERVAL_SECOND_TO_MILLISECOND, SECOND, MILLISECOND, true},
+			{TCI_SQL_INTERVAL_MILLISECOND, MILLISECOND, MILLISECOND, true},
+		};
+		for (auto &temporal : TYPES)
+		{
+			if (temporal.type == sqlType)
+				return &temporal;
+		}
+		return NULL;
+	}
+
+	/** datetimes with a year are points in time, others are times of the day or durations */
+	bool isDate() const
+	{
+		return first == YEAR && !interval;
+	}
+
+	/**
+	 * epoch milliseconds of a datetime with year (interpreted as UTC), milliseconds since midnight
+	 * of a time of the day or milliseconds of an interval. Omitted trailing fields are 0.
+	 * Returns false if the text does not match the range.
+	 */
+	bool parse(const char *text, double &ms) const
+	{
+		int64_t fields[] = {1970, 1, interval ? 0 : 1, 0, 0, 0, 0};
+		auto p = text;
+		while (*p == ' ')
+			p++;
+		bool negative = interval && *p == '-';
+		if (negative)
+			p++;
+		for (int field = first; field <= last; field++)
+		{
+			if (field > first && !*p)
+				break; // trailing fields omitted
+			if (field > first && !isDigit(*p))
+				p++; // separator
+			if (!isDigit(*p))
+				return false;
+			int64_t value = 0;
+			int digits = 0;
+			for (; isDigit(*p); p++, digits++)
+				value = value * 10 + (*p - '0');
+			if (field == MILLISECOND && field > first)
+			{
+				// fraction of a second
+				for (; digits < 3; digits++)
+					value *= 10;
+				for (; digits > 3; digits--)
+					value /= 10;
+			}
+			fields[field] = value;
+		}
+		while (*p == ' ')
+			p++;
+		if (*p)
+			return false;
+
+		ms = (double)(((fields[HOUR] * 60 + fields[MINUTE]) * 60 + fields[SECOND]) * 1000 + fields[MILLISECOND]);
+		if (first == YEAR)
+			ms += daysFromCivil(fields[YEAR], fields[MONTH], fields[DAY]) * 86400000.0;
+		else if (interval)
+			ms += fields[DAY] * 86400000.0;
+		if (negative)
+			ms = -ms;
+		return true;
+	}
+
+	/** days since 1970-01-01 of a date in the proleptic gregorian calendar */
+	static int64_t daysFromCivil(int64_t year, int64_t month, int64_t day)
+	{
+		year -= month <= 2;
+		auto era = (year >= 0 ? year : year - 399) / 400;
+		auto yearOfEra = year - era * 400;
+		auto dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+		auto dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+		return era * 146097 + dayOfEra - 719468;
+	}
+
+	static bool isDigit(char c)
+	{
+		return c >= '0' && c <= '9';
+	}
+};
+
+/**
+ * growable storage of one column in columnar fetch mode.
+ * it is filled without creating js values and converted to typed arrays once per batch.
+ */
+struct ColumnBuffer
+{
+	enum Kind
+	{
+		DOUBLE,	  // Float64Array
+		FLOAT,	  // Float64Array, read as float like TCI::getFloatValue
+		INT32,	  // Int32Array
+		INT64,	  // BigInt64Array
+		BOOL,	  // Uint8Array
+		BYTES,	  // offsets + binary data
+		CHARS,	  // offsets + utf-8 data
+		TEMPORAL, // Float64Array of milliseconds, @see Temporal
+	};
+
+	TCIColumnnumber col;
+	int type;
+	std::string name;
+	Kind kind;
+	uint32_t length = 0;
+	std::vector<uint8_t> nulls;		   // packed bitmap, bit set if the value IS NULL
+	std::vector<char> values;		   // fixed width values
+	std::vector<uint32_t> offsets{0}; // start of each variable width value in data
+	std::string data;
+	size_t width = 64; // bytes reserved to read a character value, grows to the longest value
+	const Temporal *temporal = NULL;
+	bool asDate = false; // row values of a temporal column are js Dates
+
+	ColumnBuffer(TCIColumnnumber col, int type, std::string name, bool typeCast, Temporal::Cast dateCast = Temporal::STRING)
+		: col(col), type(type), name(name), kind(getKind(type, typeCast))
+	{
+		if (typeCast && dateCast != Temporal::STRING && (temporal = Temporal::of(type)))
+		{
+			kind = TEMPORAL;
+			asDate = dateCast == Temporal::DATE && temporal->isDate();
+		}
+	}
+
+	/** mirrors the type dispatch of TCI::getValue */
+	static Kind getKind(int sqlType, bool typeCast)
+	{
+		if (!typeCast)
+			return CHARS;
+
+		switch (sqlType)
+		{
+		case TCI_SQL_BOOL:
+			return BOOL;
+		case TCI_SQL_TINYINT:
+		case TCI_SQL_SMALLINT:
+		case TCI_SQL_INTEGER:
+			return INT32;
+		case TCI_SQL_BIGINT:
+			return INT64;
+		case TCI_SQL_FLOAT:
+			return FLOAT;
+		case TCI_SQL_DOUBLE:
+		case TCI_SQL_NUMERIC:
+			return DOUBLE;
+		case TCI_SQL_BLOB:
+		case TCI_SQL_BINARY:
+			return BYTES;
+		default:
+			return CHARS;
+		}
+	}
+
+	/** append a fixed width value, value is ignored if isNull */
+	void push(const void *value, size_t size, bool isNull)
+	{
+		auto offset = values.size();
+		values.resize(offset + size, 0);
+		if (!isNull)
+			memcpy(&values[offset], value, size);
+		pushNull(isNull);
+	}
+
+	/** terminate a variable width value that was written to data */
+	void pushVariable(bool isNull)
+	{
+		offsets.push_back((uint32_t)data.size());
+		pushNull(isNull);
+	}
+
+	void pushNull(bool isNull)
+	{
+		if (length % 8 == 0)
+			nulls.push_back(0);
+		if (isNull)
+			nulls.back() |= 1 << (length % 8);
+		length++;
+	}
+
+	Napi::Object toJs(Napi::Env env)
+	{
+		auto column = Napi::Object::New(env);
+		column.Set("name", name);
+		column.Set("type", type);
+		column.Set("nulls", Napi::Uint8Array::New(env, nulls.size(), copy(env, nulls.data(), nulls.size()), 0));
+		switch (kind)
+		{
+		case DOUBLE:
+		case FLOAT:
+		case TEMPORAL:
+			column.Set("values", Napi::Float64Array::New(env, length, copy(env, values.data(), values.size()), 0));
+			break;
+		case INT32:
+			column.Set("values", Napi::Int32Array::New(env, length, copy(env, values.data(), values.size()), 0));
+			break;
+		case INT64:
+#if NAPI_VERSION > 5
+			column.Set("values", Napi::BigInt64Array::New(env, length, copy(env, values.data(), values.size()), 0));
+#else
+			{
+				// BigInt64Array requires napi version 6, fall back to doubles
+				auto doubles = Napi::Float64Array::New(env, length);
+				for (uint32_t i = 0; i < length; i++)
+					doubles.Data()[i] = (double)((int64_t *)values.data())[i];
+				column.Set("values", doubles);
+			}
+#endif
+			break;
+		case BOOL:
+			column.Set("values", Napi::Uint8Array::New(env, length, copy(env, values.data(), values.size()), 0));
+			break;
+		case BYTES:
+		case CHARS:
+			column.Set("offsets", Napi::Uint32Array::New(env, offsets.size(), copy(env, offsets.data(), offsets.size() * sizeof(uint32_t)), 0));
+			column.Set("data", Napi::Buffer<char>::Copy(env, data.data(), data.size()));
+			break;
+		}
+		return column;
+	}
+
+	bool isNull(uint32_t row)
+	{
+		return nulls[row / 8] & (1 << (row % 8));
+	}
+
+	/** the js value of a single cell, the same as TCI::getValue returns for it */
+	Napi::Value getValue(Napi::Env env, uint32_t row, StringInterner *interner = nullptr)
+	{
+		if (isNull(row))
+			return env.Null();
+
+		switch (kind)
+		{
+		case DOUBLE:
+		case FLOAT:
+			return Napi::Number::New(env, get<double>(row));
+		case INT32:
+			return Napi::Number::New(env, get<int32_t>(row));
+		case INT64:
+			return Napi::Number::New(env, (double)get<int64_t>(row));
+		case BOOL:
+			return Napi::Boolean::New(env, get<uint8_t>(row) != 0);
+		case TEMPORAL:
+#if NAPI_VERSION > 4
+			if (asDate)
+				return Napi::Date::New(env, get<double>(row));
+#endif
+			return Napi::Number::New(env, get<double>(row));
+		case BYTES:
+			return Napi::Buffer<char>::Copy(env, data.data() + offsets[row], offsets[row + 1] - offsets[row]);
+		case CHARS:
+		default:
+			if (interner)
+				return interner->get(env, data.data() + offsets[row], offsets[row + 1] - offsets[row]);
+			return newString(env, data.data() + offsets[row], offsets[row + 1] - offsets[row]);
+		}
+	}
+
+	template <typename T>
+	T get(uint32_t row)
+	{
+		T value;
+		memcpy(&value, &values[row * sizeof(T)], sizeof(T));
+		return value;
+	}
+
+	/** empty the buffer for the next batch, its memory is kept */
+	void clear()
+	{
+		length = 0;
+		nulls.clear();
+		values.clear();
+		offsets.resize(1);
+		data.clear();
+	}
 
+	/** native memory held by the buffer */
+	size_t size() const
+	{
+		return nulls.size() + values.size() + offsets.size() * sizeof(uint32_t) + data.size();
+	}
+
+	static Napi::ArrayBuffer copy(Napi::Env env, const void *data, size_t size)
+	{
+		auto buffer = Napi::ArrayBuffer::New(env, size);
+		if (size)
+			memcpy(buffer.Data(), data, size);
+		return buffer;
+	}
+};
+
+/**
+ * minimal flatbuffers builder for the metadata of arrow ipc messages.
+ * like the flatbuffers library it builds back to front, so objects are created before the tables referencing them.
+ * positions are counted from the end of the buffer.
+ */
+class FlatBuilder
+{
 public:
-	TCI(const Napi::CallbackInfo &info) : Napi::ObjectWrap<TCI>(info), env(info.Env())
+	void startTable()
 	{
+		fields.clear();
+		tableEnd = buffer.size();
 	}
 
-	~TCI()
+	template <typename T>
+	void add(uint16_t field, T value)
 	{
-		free();
+		prep(sizeof(T), sizeof(T));
+		push(value);
+		fields.push_back({field, buffer.size()});
 	}
 
-	static void Init(Napi::Env env, Napi::Object exports)
+	void addOffset(uint16_t field, uint32_t position)
 	{
-		// define the js class wrapper
-		auto tci = DefineClass(env, "TCI", {InstanceMethod<&TCI::connect>("connect"),										  //
-											InstanceMethod<&TCI::executeDirect>("executeDirect"),							  //
-											InstanceMethod<&TCI::prepare>("prepare"),										  //
-											InstanceMethod<&TCI::execute>("execute"),										  //
-											InstanceMethod<&TCI::setParam>("setParam"),										  //
-											InstanceMethod<&TCI::fetch>("fetch"),											  //
-											InstanceMethod<&TCI::getState>("getState"),										  //
-											InstanceMethod<&TCI::getResultSetAttribute>("getResultSetAttribute"),			  //
-											InstanceMethod<&TCI::getResultSetStringAttribute>("getResultSetStringAttribute"), //
-											InstanceMethod<&TCI::getValue>("getValue"),										  //
-											InstanceMethod<&TCI::getValueAsBuffer>("getValueAsBuffer"),						  //
-											InstanceMethod<&TCI::getQueryType>("getQueryType"),								  //
-											InstanceMethod<&TCI::close>("close"),											  //
-											InstanceMethod<&TCI::setTypeCast>("setTypeCast"),								  //
-											InstanceMethod<&TCI::beginTransaction>("beginTransaction"),						  //
-											InstanceMethod<&TCI::commit>("commit"),											  //
-											InstanceMethod<&TCI::rollback>("rollback"),										  //
-											InstanceMethod<&TCI::getIsNull>("getIsNull"),									  //
-											InstanceMethod<&TCI::getVersionInfo>("getVersionInfo")});
-		exports.Set("TCI", tci);
+		prep(4, 4);
+		push<uint32_t>((uint32_t)(buffer.size() + 4 - position));
+		fields.push_back({field, buffer.size()});
+	}
+
+	uint32_t endTable()
+	{
+		prep(4, 4);
+		push<int32_t>(0); // offset of the vtable, patched below
+		auto table = buffer.size();
+		uint16_t count = 0;
+		for (auto &field : fields)
+			count = std::max(count, (uint16_t)(field.first + 1));
+		std::vector<uint16_t> vtable(2 + count, 0);
+		vtable[0] = (uint16_t)(vtable.size() * sizeof(uint16_t));
+		vtable[1] = (uint16_t)(table - tableEnd);
+		for (auto &field : fields)
+			vtable[2 + field.first] = (uint16_t)(table - field.second);
+		for (auto it = vtable.rbegin(); it != vtable.rend(); it++)
+			push(*it);
+		int32_t offset = (int32_t)(buffer.size() - table);
+		memcpy(&buffer[buffer.size() - table], &offset, sizeof(offset));
+		return (uint32_t)table;
+	}
+
+	uint32_t createString(const std::string &value)
+	{
+		prep(4, value.size() + 5);
+		buffer.insert(0, 1, '\0');
+		buffer.insert(0, value);
+		push<uint32_t>((uint32_t)value.size());
+		return (uint32_t)buffer.size();
+	}
+
+	/** vector of tables or other objects */
+	uint32_t createVector(const std::vector<uint32_t> &positions)
+	{
+		prep(4, (positions.size() + 1) * 4);
+		for (auto it = positions.rbegin(); it != positions.rend(); it++)
+			push<uint32_t>((uint32_t)(buffer.size() + 4 - *it));
+		push<uint32_t>((uint32_t)positions.size());
+		return (uint32_t)buffer.size();
+	}
+
+	/** vector of structs of two longs, e.g. arrow's FieldNode and Buffer */
+	uint32_t createStructs(const std::vector<std::pair<int64_t, int64_t>> &items)
+	{
+		prep(8, items.size() * 16);
+		for (auto it = items.rbegin(); it != items.rend(); it++)
+		{
+			push(it->second);
+			push(it->first);
+		}
+		push<uint32_t>((uint32_t)items.size());
+		return (uint32_t)buffer.size();
+	}
+
+	/** the finished buffer with the given root table, its size is a multiple of 8 */
+	const std::string &finish(uint32_t root)
+	{
+		prep(8, 4);
+		push<uint32_t>((uint32_t)(buffer.size() + 4 - root));
+		return buffer;
+	}
+
+private:
+	std::string buffer;
+	size_t tableEnd = 0;
+	std::vector<std::pair<uint16_t, size_t>> fields; // id and position of the fields of the current table
+
+	/** pad, so that the buffer is aligned after writing size bytes */
+	void prep(size_t align, size_t size)
+	{
+		buffer.insert(0, (align - (buffer.size() + size) % align) % align, '\0');
+	}
+
+	template <typename T>
+	void push(T value)
+	{
+		buffer.insert(0, (const char *)&value, sizeof(T));
+	}
+};
+
+/**
+ * writes the rows of a result set to a file as csv, ndjson or arrow ipc stream.
+ * the rows are fetched into column buffers and serialized from them, no js value is created.
+ */
+struct Export
+{
+	enum Format
+	{
+		CSV,
+		NDJSON,
+		ARROW, // arrow ipc stream, a record batch per fetched batch
+	};
+
+	static const size_t FLUSH_SIZE = 64 * 1024;
+
+	Format format = CSV;
+	std::string path;
+	int fd = -1;			   // written instead of path if set, it is not closed
+	bool header = true;		   // csv header line of column names
+	char delimiter = ',';	   // csv field delimiter
+	uint32_t batchSize = 8192; // rows fetched per batch
+	uint64_t rows = 0;
+	uint64_t bytes = 0;
+
+	~Export()
+	{
+		if (file)
+			fclose(file);
+	}
+
+	static bool parseFormat(const std::string &name, Format &format)
+	{
+		static const std::pair<const char *, Format> FORMATS[] = {{"csv", CSV}, {"ndjson", NDJSON}, {"arrow", ARROW}};
+		for (auto &it : FORMATS)
+		{
+			if (name == it.first)
+			{
+				format = it.second;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/** open the file and write the csv header or arrow schema */
+	void begin(std::vector<ColumnBuffer> &columns)
+	{
+		file = fd >= 0 ? openFd(fd) : fopen(path.c_str(), "wb");
+		if (!file)
+			throw std::runtime_error("cannot open export file: " + std::string(strerror(errno)));
+
+		switch (format)
+		{
+		case CSV:
+			if (!header)
+				break;
+			for (size_t i = 0; i < columns.size(); i++)
+			{
+				if (i)
+					out += delimiter;
+				writeText(columns[i].name.data(), columns[i].name.size());
+			}
+			out += '\n';
+			break;
+		case NDJSON:
+			for (auto &column : columns)
+			{
+				keys.emplace_back();
+				std::swap(keys.back(), out);
+				writeText(column.name.data(), column.name.size());
+				out += ':';
+				std::swap(keys.back(), out);
+			}
+			break;
+		case ARROW:
+			writeSchema(columns);
+			break;
+		}
+	}
+
+	void write(std::vector<ColumnBuffer> &columns, uint32_t count)
+	{
+		rows += count;
+		if (format == ARROW)
+		{
+			writeRecordBatch(columns, count);
+			return;
+		}
+		for (uint32_t row = 0; row < count; row++)
+		{
+			if (format == NDJSON)
+				out += '{';
+			for (size_t i = 0; i < columns.size(); i++)
+			{
+				if (i)
+					out += format == NDJSON ? ',' : delimiter;
+				if (format == NDJSON)
+					out += keys[i];
+				if (!columns[i].isNull(row))
+					writeValue(columns[i], row);
+				else if (format == NDJSON)
+					out += "null";
+			}
+			out += format == NDJSON ? "}\n" : "\n";
+			if (out.size() >= FLUSH_SIZE)
+				flush();
+		}
+	}
+
+	/** write the end of the arrow stream and close the file */
+	void end()
+	{
+		if (format == ARROW)
+		{
+			uint32_t eos[] = {0xFFFFFFFF, 0};
+			put(eos, sizeof(eos));
+		}
+		flush();
+		auto closed = fclose(file);
+		file = NULL;
+		if (closed != 0)
+			throw std::runtime_error("cannot write export file: " + std::string(strerror(errno)));
+	}
+
+private:
+	FILE *file = NULL;
+	std::string out;				// buffered output, written to the file when it exceeds FLUSH_SIZE
+	std::vector<std::string> keys; // json keys of the columns
+
+	/** a stream of a duplicate of the file descriptor, so closing it keeps the caller's one open */
+	static FILE *openFd(int fd)
+	{
+#ifdef _WIN32
+		int copy = _dup(fd);
+		auto file = copy < 0 ? NULL : _fdopen(copy, "wb");
+		if (!file && copy >= 0)
+			_close(copy);
+#else
+		int copy = dup(fd);
+		auto file = copy < 0 ? NULL : fdopen(copy, "wb");
+		if (!file && copy >= 0)
+			close(copy);
+#endif
+		return file;
+	}
+
+	void flush()
+	{
+		if (out.empty())
+			return;
+		if (fwrite(out.data(), 1, out.size(), file) != out.size())
+			throw std::runtime_error("cannot write export file: " + std::string(strerror(errno)));
+		bytes += out.size();
+		out.clear();
+	}
+
+	/** write data, large blocks are written directly instead of being copied to the output buffer */
+	void put(const void *data, size_t size)
+	{
+		if (size < FLUSH_SIZE)
+		{
+			out.append((const char *)data, size);
+			if (out.size() >= FLUSH_SIZE)
+				flush();
+			return;
+		}
+		flush();
+		if (fwrite(data, 1, size, file) != size)
+			throw std::runtime_error("cannot write export file: " + std::string(strerror(errno)));
+		bytes += size;
+	}
+
+	/** a cell of csv or ndjson, mirrors the js values of ColumnBuffer::getValue */
+	void writeValue(ColumnBuffer &column, uint32_t row)
+	{
+		switch (column.kind)
+		{
+		case ColumnBuffer::DOUBLE:
+		case ColumnBuffer::FLOAT:
+		case ColumnBuffer::TEMPORAL:
+			writeNumber(column.get<double>(row));
+			break;
+		case ColumnBuffer::INT32:
+			out += std::to_string(column.get<int32_t>(row));
+			break;
+		case ColumnBuffer::INT64:
+			out += std::to_string(column.get<int64_t>(row));
+			break;
+		case ColumnBuffer::BOOL:
+			out += column.get<uint8_t>(row) ? "true" : "false";
+			break;
+		case ColumnBuffer::BYTES:
+			writeHex(column.data.data() + column.offsets[row], column.offsets[row + 1] - column.offsets[row]);
+			break;
+		case ColumnBuffer::CHARS:
+			writeText(column.data.data() + column.offsets[row], column.offsets[row + 1] - column.offsets[row]);
+			break;
+		}
+	}
+
+	/** the shortest representation that reads back as the same double, non-finite numbers are null in json */
+	void writeNumber(double value)
+	{
+		if (!std::isfinite(value))
+		{
+			if (format == NDJSON)
+				out += "null";
+			else
+				out += std::isnan(value) ? "NaN" : value < 0 ? "-Infinity"
+															 : "Infinity";
+			return;
+		}
+		char text[32];
+		for (int precision = 15; precision <= 17; precision++)
+		{
+			snprintf(text, sizeof(text), "%.*g", precision, value);
+			if (strtod(text, NULL) == value)
+				break;
+		}
+		out += text;
+	}
+
+	/** binary values as hex string */
+	void writeHex(const char *data, size_t size)
+	{
+		static const char DIGITS[] = "0123456789abcdef";
+		if (format == NDJSON)
+			out += '"';
+		for (size_t i = 0; i < size; i++)
+		{
+			out += DIGITS[(uint8_t)data[i] >> 4];
+			out += DIGITS[(uint8_t)data[i] & 0xf];
+		}
+		if (format == NDJSON)
+			out += '"';
+	}
+
+	/** a json string or a csv field, quoted if it contains the delimiter, a quote or a line break */
+	void writeText(const char *data, size_t size)
+	{
+		if (format == CSV)
+		{
+			bool quote = false;
+			for (size_t i = 0; i < size && !quote; i++)
+				quote = data[i] == delimiter || data[i] == '"' || data[i] == '\n' || data[i] == '\r';
+			if (!quote)
+			{
+				out.append(data, size);
+				return;
+			}
+			out += '"';
+			for (size_t i = 0; i < size; i++)
+			{
+				if (data[i] == '"')
+					out += '"';
+				out += data[i];
+			}
+			out += '"';
+			return;
+		}
+		out += '"';
+		for (size_t i = 0; i < size; i++)
+		{
+			auto c = (uint8_t)data[i];
+			if (c == '"' || c == '\\')
+			{
+				out += '\\';
+				out += (char)c;
+			}
+			else if (c == '\n')
+				out += "\\n";
+			else if (c == '\r')
+				out += "\\r";
+			else if (c == '\t')
+				out += "\\t";
+			else if (c < 0x20)
+			{
+				char escaped[8];
+				snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+				out += escaped;
+			}
+			else
+				out += (char)c;
+		}
+		out += '"';
+	}
+
+	/**********************************
+	 * ARROW IPC, @see https://arrow.apache.org/docs/format/Columnar.html#serialization-and-interprocess-communication-ipc
+	 *********************************/
+	enum ArrowType : uint8_t
+	{
+		ARROW_INT = 2,
+		ARROW_FLOATING_POINT = 3,
+		ARROW_BINARY = 4,
+		ARROW_UTF8 = 5,
+		ARROW_BOOL = 6,
+	};
+
+	enum ArrowHeader : uint8_t
+	{
+		ARROW_SCHEMA = 1,
+		ARROW_RECORD_BATCH = 3,
+	};
+
+	void writeSchema(std::vector<ColumnBuffer> &columns)
+	{
+		FlatBuilder builder;
+		std::vector<uint32_t> fields;
+		for (auto &column : columns)
+		{
+			ArrowType type;
+			builder.startTable();
+			switch (column.kind)
+			{
+			case ColumnBuffer::INT32:
+			case ColumnBuffer::INT64:
+				type = ARROW_INT;
+				builder.add<int32_t>(0, column.kind == ColumnBuffer::INT32 ? 32 : 64); // bitWidth
+				builder.add<uint8_t>(1, 1);												// is_signed
+				break;
+			case ColumnBuffer::DOUBLE:
+			case ColumnBuffer::FLOAT:
+			case ColumnBuffer::TEMPORAL:
+				type = ARROW_FLOATING_POINT;
+				builder.add<int16_t>(0, 2); // precision DOUBLE
+				break;
+			case ColumnBuffer::BOOL:
+				type = ARROW_BOOL;
+				break;
+			case ColumnBuffer::BYTES:
+				type = ARROW_BINARY;
+				break;
+			default:
+				type = ARROW_UTF8;
+				break;
+			}
+			auto typeTable = builder.endTable();
+			auto name = builder.createString(column.name);
+			auto children = builder.createVector({});
+			builder.startTable();
+			builder.addOffset(0, name);
+			builder.add<uint8_t>(1, 1); // nullable
+			builder.add<uint8_t>(2, type);
+			builder.addOffset(3, typeTable);
+			builder.addOffset(5, children);
+			fields.push_back(builder.endTable());
+		}
+		auto fieldVector = builder.createVector(fields);
+		builder.startTable();
+		builder.addOffset(1, fieldVector);
+		writeMessage(builder, ARROW_SCHEMA, builder.endTable(), 0);
+	}
+
+	void writeRecordBatch(std::vector<ColumnBuffer> &columns, uint32_t count)
+	{
+		std::list<std::string> owned; // converted buffers, arrow validity bits are set for valid values
+		std::vector<std::pair<const char *, size_t>> body;
+		std::vector<std::pair<int64_t, int64_t>> nodes;	  // length, null count
+		std::vector<std::pair<int64_t, int64_t>> buffers; // offset, length in the body
+		int64_t bodyLength = 0;
+		auto addBuffer = [&](const void *data, size_t size)
+		{
+			buffers.push_back({bodyLength, (int64_t)size});
+			body.push_back({(const char *)data, size});
+			bodyLength += (size + 7) & ~(size_t)7;
+		};
+
+		for (auto &column : columns)
+		{
+			int64_t nullCount = 0;
+			for (uint32_t row = 0; row < count; row++)
+				nullCount += column.isNull(row) ? 1 : 0;
+			nodes.push_back({count, nullCount});
+			if (nullCount)
+			{
+				owned.emplace_back(column.nulls.size(), '\0');
+				for (size_t i = 0; i < column.nulls.size(); i++)
+					owned.back()[i] = (char)~column.nulls[i];
+				addBuffer(owned.back().data(), owned.back().size());
+			}
+			else
+				addBuffer(NULL, 0); // no validity bitmap if all values are valid
+
+			switch (column.kind)
+			{
+			case ColumnBuffer::BOOL:
+				owned.emplace_back((count + 7) / 8, '\0');
+				for (uint32_t row = 0; row < count; row++)
+				{
+					if (column.get<uint8_t>(row))
+						owned.back()[row / 8] |= 1 << (row % 8);
+				}
+				addBuffer(owned.back().data(), owned.back().size());
+				break;
+			case ColumnBuffer::BYTES:
+			case ColumnBuffer::CHARS:
+				addBuffer(column.offsets.data(), column.offsets.size() * sizeof(uint32_t));
+				addBuffer(column.data.data(), column.data.size());
+				break;
+			default:
+				addBuffer(column.values.data(), column.values.size());
+				break;
+			}
+		}
+
+		FlatBuilder builder;
+		auto nodeVector = builder.createStructs(nodes);
+		auto bufferVector = builder.createStructs(buffers);
+		builder.startTable();
+		builder.add<int64_t>(0, count);
+		builder.addOffset(1, nodeVector);
+		builder.addOffset(2, bufferVector);
+		writeMessage(builder, ARROW_RECORD_BATCH, builder.endTable(), bodyLength);
+
+		static const char PADDING[8] = {0};
+		for (auto &buffer : body)
+		{
+			if (buffer.second)
+				put(buffer.first, buffer.second);
+			put(PADDING, ((buffer.second + 7) & ~(size_t)7) - buffer.second);
+		}
+	}
+
+	/** an encapsulated message: continuation marker, metadata size, Message flatbuffer, followed by the body */
+	void writeMessage(FlatBuilder &builder, ArrowHeader type, uint32_t header, int64_t bodyLength)
+	{
+		builder.startTable();
+		builder.add<int16_t>(0, 4); // version V5
+		builder.add<uint8_t>(1, type);
+		builder.addOffset(2, header);
+		builder.add<int64_t>(3, bodyLength);
+		auto &metadata = builder.finish(builder.endTable());
+		uint32_t prefix[] = {0xFFFFFFFF, (uint32_t)metadata.size()};
+		put(prefix, sizeof(prefix));
+		put(metadata.data(), metadata.size());
+	}
+};
+
+/**
+ * a parameter value converted from js.
+ * it owns its data, so it can be bound after the js value is gone or off the main thread.
+ */
+struct BindValue
+{
+	Int2 type = TCI_C_CHAR;
+	Int2 isNull = 0;
+	union
+	{
+		Int1 int1;
+		Int4 int4;
+		Int8 int8;
+		double float8;
+	};
+	std::string bytes; // TCI_C_CHAR and TCI_C_BYTE data
+
+	BindValue() : int8(0)
+	{
+	}
+
+	/** infer the tci type of a js value natively */
+	static BindValue from(Napi::Value value)
+	{
+		BindValue bind;
+		bind.assign(value);
+		return bind;
+	}
+
+	/** convert a js value, the string storage of the previous value is reused */
+	void assign(Napi::Value value)
+	{
+		type = TCI_C_CHAR;
+		isNull = 0;
+		int8 = 0;
+		if (value.IsNull() || value.IsUndefined())
+		{
+			isNull = 1;
+		}
+		else if (value.IsBoolean())
+		{
+			type = TCI_C_INT1;
+			int1 = value.As<Napi::Boolean>().Value() ? 1 : 0;
+		}
+		else if (value.IsNumber())
+		{
+			assignNumber(value.As<Napi::Number>().DoubleValue());
+		}
+		else if (value.IsBigInt())
+		{
+			bool lossless;
+			type = TCI_C_INT8;
+			int8 = value.As<Napi::BigInt>().Int64Value(&lossless);
+		}
+		else if (value.IsBuffer())
+		{
+			auto buffer = value.As<Napi::Buffer<char>>();
+			type = TCI_C_BYTE;
+			bytes.assign(buffer.Data(), buffer.Length());
+		}
+		else
+		{
+			assignString(value.ToString());
+		}
+	}
+
+	/**
+	 * convert a js value of a bind plan, which mostly has the type of the value of the previous execution.
+	 * Strings and numbers of the previous type are converted after a single type check, others as by assign.
+	 */
+	void reassign(Napi::Value value)
+	{
+		auto kind = value.Type();
+		if (!isNull && kind == napi_string && type == TCI_C_CHAR)
+			assignString(value.As<Napi::String>());
+		else if (!isNull && kind == napi_number && (type == TCI_C_INT4 || type == TCI_C_INT8 || type == TCI_C_DOUBLE))
+			assignNumber(value.As<Napi::Number>().DoubleValue());
+		else
+			assign(value);
+	}
+
+	/** integral numbers as int4 or int8, others as double */
+	void assignNumber(double d)
+	{
+		isNull = 0;
+		int8 = 0;
+		if (std::trunc(d) == d && d >= INT32_MIN && d <= INT32_MAX)
+		{
+			type = TCI_C_INT4;
+			int4 = (Int4)d;
+		}
+		else if (std::trunc(d) == d && std::abs(d) <= 9007199254740991.0) // Number.MAX_SAFE_INTEGER
+		{
+			type = TCI_C_INT8;
+			int8 = (Int8)d;
+		}
+		else
+		{
+			type = TCI_C_DOUBLE;
+			float8 = d;
+		}
+	}
+
+	/** encode directly into bytes instead of a temporary std::string */
+	void assignString(Napi::String string)
+	{
+		type = TCI_C_CHAR;
+		isNull = 0;
+		size_t length;
+		napi_get_value_string_utf8(string.Env(), string, NULL, 0, &length);
+		bytes.resize(length);
+		napi_get_value_string_utf8(string.Env(), string, &bytes[0], length + 1, NULL);
+	}
+
+	void *data()
+	{
+		return type == TCI_C_CHAR || type == TCI_C_BYTE ? (void *)bytes.data() : (void *)&int8;
+	}
+
+	Int4 size()
+	{
+		switch (type)
+		{
+		case TCI_C_CHAR:
+			return (Int4)bytes.size() + 1; // including the terminating null character
+		case TCI_C_BYTE:
+			return (Int4)bytes.size();
+		case TCI_C_INT1:
+			return sizeof(int1);
+		case TCI_C_INT4:
+			return sizeof(int4);
+		default:
+			return sizeof(int8);
+		}
+	}
+};
+
+/**
+ * bind plan of a prepared statement: the names of named parameters and the converted values,
+ * whose string storage is reused by every execution
+ */
+struct BindPlan
+{
+	bool named = false;
+	std::vector<std::string> names;
+	std::vector<BindValue> values;
+
+	/** plan positional parameters */
+	void compile(uint32_t length)
+	{
+		named = false;
+		names.clear();
+		values.resize(length);
+	}
+
+	/** plan named parameters by the property names of the parameter object */
+	void compile(Napi::Object parameters)
+	{
+		auto keys = parameters.GetPropertyNames();
+		named = true;
+		names.resize(keys.Length());
+		values.resize(keys.Length());
+		for (uint32_t i = 0; i < keys.Length(); i++)
+			names[i] = keys.Get(i).ToString().Utf8Value();
+	}
+};
+
+/** sql type names exported as SqlType and reported as column typeName */
+static const struct
+{
+	const char *name;
+	int type;
+} SQL_TYPES[] = {
+	{"BOOL", TCI_SQL_BOOL},
+	{"TINYINT", TCI_SQL_TINYINT},
+	{"SMALLINT", TCI_SQL_SMALLINT},
+	{"INTEGER", TCI_SQL_INTEGER},
+	{"NUMERIC", TCI_SQL_NUMERIC},
+	{"FLOAT", TCI_SQL_FLOAT},
+	{"DOUBLE", TCI_SQL_DOUBLE},
+	{"CHAR", TCI_SQL_CHAR},
+	{"VARCHAR", TCI_SQL_VARCHAR},
+	{"BINARY", TCI_SQL_BINARY},
+	{"BIT", TCI_SQL_BIT},
+	{"BLOB", TCI_SQL_BLOB},
+	{"BITSHORT", TCI_SQL_BITSHORT},
+	{"BIGINT", TCI_SQL_BIGINT},
+	{"CLOB", TCI_SQL_CLOB},
+	{"DATE", TCI_SQL_DATE},
+	{"DATE_YEAR", TCI_SQL_DATE_YEAR},
+	{"DATE_YEAR_TO_MONTH", TCI_SQL_DATE_YEAR_TO_MONTH},
+	{"DATE_YEAR_TO_DAY", TCI_SQL_DATE_YEAR_TO_DAY},
+	{"DATE_YEAR_TO_HOUR", TCI_SQL_DATE_YEAR_TO_HOUR},
+	{"DATE_YEAR_TO_MINUTE", TCI_SQL_DATE_YEAR_TO_MINUTE},
+	{"DATE_YEAR_TO_SECOND", TCI_SQL_DATE_YEAR_TO_SECOND},
+	{"DATE_YEAR_TO_MILLISECOND", TCI_SQL_DATE_YEAR_TO_MILLISECOND},
+	{"DATE_MONTH", TCI_SQL_DATE_MONTH},
+	{"DATE_MONTH_TO_DAY", TCI_SQL_DATE_MONTH_TO_DAY},
+	{"DATE_MONTH_TO_HOUR", TCI_SQL_DATE_MONTH_TO_HOUR},
+	{"DATE_MONTH_TO_MINUTE", TCI_SQL_DATE_MONTH_TO_MINUTE},
+	{"DATE_MONTH_TO_SECOND", TCI_SQL_DATE_MONTH_TO_SECOND},
+	{"DATE_MONTH_TO_MILLISECOND", TCI_SQL_DATE_MONTH_TO_MILLISECOND},
+	{"DATE_DAY", TCI_SQL_DATE_DAY},
+	{"DATE_DAY_TO_HOUR", TCI_SQL_DATE_DAY_TO_HOUR},
+	{"DATE_DAY_TO_MINUTE", TCI_SQL_DATE_DAY_TO_MINUTE},
+	{"DATE_DAY_TO_SECOND", TCI_SQL_DATE_DAY_TO_SECOND},
+	{"DATE_DAY_TO_MILLISECOND", TCI_SQL_DATE_DAY_TO_MILLISECOND},
+	{"DATE_HOUR", TCI_SQL_DATE_HOUR},
+	{"DATE_HOUR_TO_MINUTE", TCI_SQL_DATE_HOUR_TO_MINUTE},
+	{"DATE_HOUR_TO_SECOND", TCI_SQL_DATE_HOUR_TO_SECOND},
+	{"DATE_HOUR_TO_MILLISECOND", TCI_SQL_DATE_HOUR_TO_MILLISECOND},
+	{"DATE_MINUTE", TCI_SQL_DATE_MINUTE},
+	{"DATE_MINUTE_TO_SECOND", TCI_SQL_DATE_MINUTE_TO_SECOND},
+	{"DATE_MINUTE_TO_MILLISECOND", TCI_SQL_DATE_MINUTE_TO_MILLISECOND},
+	{"DATE_SECOND", TCI_SQL_DATE_SECOND},
+	{"DATE_SECOND_TO_MILLISECOND", TCI_SQL_DATE_SECOND_TO_MILLISECOND},
+	{"DATE_MILLISECOND", TCI_SQL_DATE_MILLISECOND},
+	{"TIME", TCI_SQL_TIME},
+	{"TIMESTAMP", TCI_SQL_TIMESTAMP},
+	{"INTERVAL", TCI_SQL_TYPE_INTERVAL},
+	{"INTERVAL_YEAR", TCI_SQL_INTERVAL_YEAR},
+	{"INTERVAL_YEAR_TO_MONTH", TCI_SQL_INTERVAL_YEAR_TO_MONTH},
+	{"INTERVAL_MONTH", TCI_SQL_INTERVAL_MONTH},
+	{"INTERVAL_DAY", TCI_SQL_INTERVAL_DAY},
+	{"INTERVAL_DAY_TO_HOUR", TCI_SQL_INTERVAL_DAY_TO_HOUR},
+	{"INTERVAL_DAY_TO_MINUTE", TCI_SQL_INTERVAL_DAY_TO_MINUTE},
+	{"INTERVAL_DAY_TO_SECOND", TCI_SQL_INTERVAL_DAY_TO_SECOND},
+	{"INTERVAL_DAY_TO_MILLISECOND", TCI_SQL_INTERVAL_DAY_TO_MILLISECOND},
+	{"INTERVAL_HOUR", TCI_SQL_INTERVAL_HOUR},
+	{"INTERVAL_HOUR_TO_MINUTE", TCI_SQL_INTERVAL_HOUR_TO_MINUTE},
+	{"INTERVAL_HOUR_TO_SECOND", TCI_SQL_INTERVAL_HOUR_TO_SECOND},
+	{"INTERVAL_HOUR_TO_MILLISECOND", TCI_SQL_INTERVAL_HOUR_TO_MILLISECOND},
+	{"INTERVAL_MINUTE", TCI_SQL_INTERVAL_MINUTE},
+	{"INTERVAL_MINUTE_TO_SECOND", TCI_SQL_INTERVAL_MINUTE_TO_SECOND},
+	{"INTERVAL_MINUTE_TO_MILLISECOND", TCI_SQL_INTERVAL_MINUTE_TO_MILLISECOND},
+	{"INTERVAL_SECOND", TCI_SQL_INTERVAL_SECOND},
+	{"INTERVAL_SECOND_TO_MILLISECOND", TCI_SQL_INTERVAL_SECOND_TO_MILLISECOND},
+	{"INTERVAL_MILLISECOND", TCI_SQL_INTERVAL_MILLISECOND},
+};
+
+/**
+ * column descriptors of a result set, described once per execution or once per cached statement.
+ * it holds no js values, so it can be shared and released off the main thread.
+ */
+struct Description
+{
+	struct Column
+	{
+		TCIColumnnumber col;
+		int type;
+		std::string name;
+		std::string typeName;
+		int precision = -1; // -1 if not reported by the tci library
+		int scale = -1;
+		int nullable = -1;
+	};
+
+	std::vector<Column> columns;
+
+	static std::string typeName(int type)
+	{
+		for (auto &sqlType : SQL_TYPES)
+		{
+			if (sqlType.type == type)
+				return sqlType.name;
+		}
+		return "TYPE(" + std::to_string(type) + ")";
+	}
+};
+
+/** the statements of an executeScript call, split on the main thread so they can be executed on a worker */
+struct Script
+{
+	enum State
+	{
+		OK,
+		FAILED,
+		ROLLED_BACK, // succeeded, but its transaction was rolled back by a later failure
+	};
+
+	struct Result
+	{
+		State state = OK;
+		int queryType = 0;
+		Int4 records = 0; // affected records of updates
+		double ms = 0;
+		std::string error;
+	};
+
+	std::vector<std::string> statements;
+	bool transactional = true;
+	bool stopOnError = true;
+	uint32_t timeout = 0; // milliseconds for all statements, 0 if there is no deadline
+	// result
+	std::vector<Result> results;
+	int64_t failedIndex = -1; // the statement failing the script, the number of statements if the commit did
+	std::string error;
+	int cancelled = 0; // the Cancellation::Reason of a cancelled script
+
+	/**
+	 * split a script on the semicolons outside of string literals, quoted identifiers and comments.
+	 * comments are dropped and empty statements skipped.
+	 */
+	static std::vector<std::string> split(const std::string &text)
+	{
+		std::vector<std::string> statements;
+		std::string statement;
+		auto flush = [&]()
+		{
+			auto begin = statement.find_first_not_of(" \t\r\n");
+			if (begin != std::string::npos)
+				statements.push_back(statement.substr(begin, statement.find_last_not_of(" \t\r\n") + 1 - begin));
+			statement.clear();
+		};
+		for (size_t i = 0; i < text.size(); i++)
+		{
+			auto c = text[i];
+			if (c == '\'' || c == '"')
+			{
+				// quotes are escaped by doubling them, which simply reads as two adjacent literals
+				auto end = text.find(c, i + 1);
+				end = end == std::string::npos ? text.size() : end + 1;
+				statement.append(text, i, end - i);
+				i = end - 1;
+			}
+			else if (c == '-' && i + 1 < text.size() && text[i + 1] == '-')
+			{
+				i = std::min(text.find('\n', i), text.size()) - 1;
+			}
+			else if (c == '/' && i + 1 < text.size() && text[i + 1] == '*')
+			{
+				auto end = text.find("*/", i + 2);
+				i = end == std::string::npos ? text.size() : end + 1;
+				statement += ' ';
+			}
+			else if (c == ';')
+				flush();
+			else
+				statement += c;
+		}
+		flush();
+		return statements;
+	}
+};
+
+/**
+ * reads the records of a csv or ndjson file and converts their fields to bind values of the target columns.
+ * the file is read in blocks and a record at a time, so memory stays flat regardless of the file size.
+ */
+struct Import
+{
+	enum Format
+	{
+		CSV,
+		NDJSON, // a flat json object per line, its keys are the column names
+	};
+
+	/** a target column, the tci type its fields are bound as is fixed once by the sql type of the column */
+	struct Target
+	{
+		std::string name;
+		Int2 type;
+
+		Target(const std::string &name, int sqlType) : name(name), type(typeOf(sqlType))
+		{
+		}
+
+		static Int2 typeOf(int sqlType)
+		{
+			switch (sqlType)
+			{
+			case TCI_SQL_BOOL:
+				return TCI_C_INT1;
+			case TCI_SQL_TINYINT:
+			case TCI_SQL_SMALLINT:
+			case TCI_SQL_INTEGER:
+				return TCI_C_INT4;
+			case TCI_SQL_BIGINT:
+				return TCI_C_INT8;
+			case TCI_SQL_FLOAT:
+			case TCI_SQL_DOUBLE:
+				return TCI_C_DOUBLE;
+			case TCI_SQL_BLOB:
+			case TCI_SQL_BINARY:
+				return TCI_C_BYTE;
+			default:
+				return TCI_C_CHAR; // converted by the database, e.g. numerics and datetimes
+			}
+		}
+
+		/** convert the text of a field, empty fields of non character columns are NULL. Returns false if the text is invalid */
+		bool convert(std::string &text, bool isNull, BindValue &value) const
+		{
+			value.type = type;
+			value.isNull = isNull || (text.empty() && type != TCI_C_CHAR) ? 1 : 0;
+			if (value.isNull)
+				return true;
+
+			char *end = NULL;
+			errno = 0;
+			switch (type)
+			{
+			case TCI_C_INT1:
+				if (text == "true" || text == "1")
+					value.int1 = 1;
+				else if (text == "false" || text == "0")
+					value.int1 = 0;
+				else
+					return false;
+				return true;
+			case TCI_C_INT4:
+			{
+				auto i = strtoll(text.c_str(), &end, 10);
+				value.int4 = (Int4)i;
+				return !*end && !errno && i >= INT32_MIN && i <= INT32_MAX;
+			}
+			case TCI_C_INT8:
+				value.int8 = strtoll(text.c_str(), &end, 10);
+				return !*end && !errno;
+			case TCI_C_DOUBLE:
+				value.float8 = strtod(text.c_str(), &end);
+				return !*end && !errno;
+			case TCI_C_BYTE:
+			{
+				// binaries are hex encoded like they are exported
+				if (text.size() % 2)
+					return false;
+				value.bytes.resize(text.size() / 2);
+				for (size_t i = 0; i < value.bytes.size(); i++)
+				{
+					int high = hexDigit(text[2 * i]), low = hexDigit(text[2 * i + 1]);
+					if (high < 0 || low < 0)
+						return false;
+					value.bytes[i] = (char)(high << 4 | low);
+				}
+				return true;
+			}
+			default:
+				std::swap(value.bytes, text); // the field's storage is reused for the next record
+				return true;
+			}
+		}
+
+		static int hexDigit(char c)
+		{
+			if (c >= '0' && c <= '9')
+				return c - '0';
+			if (c >= 'a' && c <= 'f')
+				return c - 'a' + 10;
+			if (c >= 'A' && c <= 'F')
+				return c - 'A' + 10;
+			return -1;
+		}
+	};
+
+	static const size_t READ_SIZE = 64 * 1024;
+	static const size_t MAX_REPORTED_REJECTS = 100; // rejected lines reported with their error
+
+	Format format = CSV;
+	std::string table;
+	std::string path;
+	std::vector<std::string> columns; // target columns in field order, from the csv header or all of the table if empty
+	bool header = true;				  // the first csv line names the columns
+	char delimiter = ',';
+	uint32_t batchSize = 10000; // rows inserted per transaction
+	bool transactional = true;
+	uint64_t maxRejects = UINT64_MAX;		 // the import fails if more lines are rejected
+	uint32_t timeout = 0;					 // milliseconds for the whole import, 0 if there is no deadline
+	std::function<void(Import &)> onProgress; // called on the worker thread after every batch
+	// result
+	std::vector<Target> targets;
+	std::vector<BindValue> values; // converted fields of the current record
+	uint64_t rows = 0;			   // inserted and committed
+	uint64_t rejected = 0;
+	uint64_t line = 0;	// line of the current record
+	uint64_t bytes = 0; // read so far
+	std::vector<std::pair<uint64_t, std::string>> rejects;
+	bool failed = false;
+	std::string error;
+	int cancelled = 0; // the Cancellation::Reason of a cancelled import
+
+	~Import()
+	{
+		if (file)
+			fclose(file);
+	}
+
+	static bool parseFormat(const std::string &name, Format &format)
+	{
+		if (name == "csv")
+			format = CSV;
+		else if (name == "ndjson")
+			format = NDJSON;
+		else
+			return false;
+		return true;
+	}
+
+	/** open the file and read the column names of the csv header, if not given */
+	void open()
+	{
+		file = fopen(path.c_str(), "rb");
+		if (!file)
+			throw std::runtime_error("cannot open import file: " + std::string(strerror(errno)));
+		if (format == CSV && header && readCsv())
+		{
+			if (columns.empty())
+				columns = fields;
+		}
+	}
+
+	/** query describing the target columns */
+	std::string describeSql()
+	{
+		return "select " + columnList() + " from " + table + " where 1 = 0";
+	}
+
+	std::string insertSql()
+	{
+		std::string sql = "insert into " + table + " (" + columnList() + ") values (";
+		for (size_t i = 0; i < targets.size(); i++)
+			sql += i ? ", ?" : "?";
+		return sql + ")";
+	}
+
+	/** fix the conversions of the described target columns */
+	void describe(const std::vector<Description::Column> &described)
+	{
+		if (columns.empty())
+		{
+			for (auto &column : described)
+				columns.push_back(column.name);
+		}
+		for (size_t i = 0; i < described.size(); i++)
+			targets.emplace_back(columns[i], described[i].type);
+		values.resize(targets.size());
+		for (size_t i = 0; i < targets.size(); i++)
+			keys[targets[i].name] = i;
+	}
+
+	/**
+	 * read and convert the next record into values, returns false at the end of the file.
+	 * sets message if the record is rejected
+	 */
+	bool read(std::string &message)
+	{
+		message.clear();
+		bool found = format == CSV ? readCsv() : readJson(message);
+		if (!found || !message.empty())
+			return found;
+		if (fields.size() != targets.size())
+		{
+			message = "expected " + std::to_string(targets.size()) + " fields but found " + std::to_string(fields.size());
+			return true;
+		}
+		for (size_t i = 0; i < targets.size(); i++)
+		{
+			if (!targets[i].convert(fields[i], nulls[i], values[i]))
+			{
+				message = "invalid value of column " + targets[i].name;
+				return true;
+			}
+		}
+		return true;
+	}
+
+	void reject(const std::string &message)
+	{
+		rejected++;
+		if (rejects.size() < MAX_REPORTED_REJECTS)
+			rejects.push_back({line, message});
+		if (rejected > maxRejects)
+			throw std::runtime_error("too many rejected lines, last at line " + std::to_string(line) + ": " + message);
+	}
+
+private:
+	FILE *file = NULL;
+	char buffer[READ_SIZE];
+	size_t position = 0;
+	size_t length = 0;
+	int last = 0;		// the last character read
+	uint64_t lines = 0; // lines read so far
+	std::vector<std::string> fields;
+	std::vector<char> nulls;
+	std::unordered_map<std::string, size_t> keys; // field index of a json key
+
+	int get()
+	{
+		if (position == length)
+		{
+			length = fread(buffer, 1, READ_SIZE, file);
+			position = 0;
+			bytes += length;
+			if (!length)
+			{
+				if (ferror(file))
+					throw std::runtime_error("cannot read import file: " + std::string(strerror(errno)));
+				return last = EOF;
+			}
+		}
+		last = (uint8_t)buffer[position++];
+		if (last == '\n')
+			lines++;
+		return last;
+	}
+
+	/** unread the last character */
+	void unget()
+	{
+		if (buffer[--position] == '\n')
+			lines--;
+	}
+
+	/** read the fields of the next csv record, empty lines are skipped. Unquoted empty fields are NULL */
+	bool readCsv()
+	{
+		int c;
+		while ((c = get()) == '\n' || c == '\r')
+			;
+		if (c == EOF)
+			return false;
+		line = lines + 1;
+		size_t count = 0;
+		while (true)
+		{
+			if (fields.size() == count)
+			{
+				fields.emplace_back();
+				nulls.push_back(0);
+			}
+			auto &field = fields[count];
+			field.clear();
+			bool quoted = c == '"';
+			if (quoted)
+			{
+				while ((c = get()) != EOF)
+				{
+					if (c == '"' && (c = get()) != '"')
+						break; // closing quote, a doubled quote is a quote
+					field += (char)c;
+				}
+			}
+			for (; c != EOF && c != delimiter && c != '\n' && c != '\r'; c = get())
+				field += (char)c;
+			nulls[count++] = !quoted && field.empty();
+			if (c != delimiter)
+				break;
+			c = get();
+		}
+		if (c == '\r' && get() != '\n' && length)
+			unget();
+		fields.resize(count);
+		nulls.resize(count);
+		return true;
+	}
+
+	/** read the next line as flat json object, fields of keys that are no target column are ignored, missing ones are NULL */
+	bool readJson(std::string &message)
+	{
+		int c;
+		while ((c = get()) == '\n' || c == '\r' || c == ' ' || c == '\t')
+			;
+		if (c == EOF)
+			return false;
+		line = lines + 1;
+		fields.resize(targets.size());
+		nulls.assign(targets.size(), 1);
+		std::string key, value;
+		if (c != '{')
+			return skipLine("expected a json object", message);
+		c = skipSpace(get());
+		while (c != '}')
+		{
+			if (c != '"' || !readJsonString(key))
+				return skipLine("expected a json key", message);
+			if (skipSpace(get()) != ':')
+				return skipLine("expected a colon after key " + key, message);
+			c = skipSpace(get());
+			value.clear();
+			bool isNull = false;
+			if (c == '"')
+			{
+				if (!readJsonString(value))
+					return skipLine("invalid json string", message);
+				c = get();
+			}
+			else
+			{
+				// numbers and literals are converted like their text
+				for (; c != EOF && c != ',' && c != '}' && c != '\n' && c != ' ' && c != '\t' && c != '\r'; c = get())
+					value += (char)c;
+				if (value == "null")
+					isNull = true;
+				else if (value.empty() || value[0] == '{' || value[0] == '[')
+					return skipLine("nested json values are not supported", message);
+			}
+			auto index = keys.find(key);
+			if (index != keys.end())
+			{
+				std::swap(fields[index->second], value);
+				nulls[index->second] = isNull;
+			}
+			c = skipSpace(c);
+			if (c == ',')
+				c = skipSpace(get());
+			else if (c != '}')
+				return skipLine("expected a comma or the end of the object", message);
+		}
+		while ((c = get()) == ' ' || c == '\t' || c == '\r')
+			;
+		if (c != '\n' && c != EOF)
+			return skipLine("expected the end of the line after the object", message);
+		return true;
+	}
+
+	/** read a json string after its opening quote */
+	bool readJsonString(std::string &value)
+	{
+		value.clear();
+		int c;
+		while ((c = get()) != '"')
+		{
+			if (c == EOF || c == '\n')
+				return false;
+			if (c != '\\')
+			{
+				value += (char)c;
+				continue;
+			}
+			switch (c = get())
+			{
+			case 'n':
+				value += '\n';
+				break;
+			case 'r':
+				value += '\r';
+				break;
+			case 't':
+				value += '\t';
+				break;
+			case 'b':
+				value += '\b';
+				break;
+			case 'f':
+				value += '\f';
+				break;
+			case 'u':
+			{
+				uint32_t code = readHex4();
+				if (code >= 0xD800 && code <= 0xDBFF)
+				{
+					// surrogate pair
+					if (get() != '\\' || get() != 'u')
+						return false;
+					uint32_t low = readHex4();
+					if (low < 0xDC00 || low > 0xDFFF)
+						return false;
+					code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+				}
+				if (code > 0x10FFFF)
+					return false;
+				appendUtf8(value, code);
+				break;
+			}
+			case EOF:
+			case '\n':
+				return false;
+			default: // quote, backslash and slash
+				value += (char)c;
+			}
+		}
+		return true;
+	}
+
+	/** the value of 4 hex digits, an invalid code point if they are not */
+	uint32_t readHex4()
+	{
+		uint32_t code = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			int c = get();
+			int digit = c == EOF ? -1 : Target::hexDigit((char)c);
+			if (digit < 0)
+				return UINT32_MAX;
+			code = code << 4 | digit;
+		}
+		return code;
+	}
+
+	static void appendUtf8(std::string &value, uint32_t code)
+	{
+		if (code < 0x80)
+			value += (char)code;
+		else if (code < 0x800)
+		{
+			value += (char)(0xC0 | code >> 6);
+			value += (char)(0x80 | (code & 0x3F));
+		}
+		else if (code < 0x10000)
+		{
+			value += (char)(0xE0 | code >> 12);
+			value += (char)(0x80 | (code >> 6 & 0x3F));
+			value += (char)(0x80 | (code & 0x3F));
+		}
+		else
+		{
+			value += (char)(0xF0 | code >> 18);
+			value += (char)(0x80 | (code >> 12 & 0x3F));
+			value += (char)(0x80 | (code >> 6 & 0x3F));
+			value += (char)(0x80 | (code & 0x3F));
+		}
+	}
+
+	int skipSpace(int c)
+	{
+		while (c == ' ' || c == '\t')
+			c = get();
+		return c;
+	}
+
+	/** reject the current line and continue after it */
+	bool skipLine(const std::string &reason, std::string &message)
+	{
+		message = reason;
+		while (last != '\n' && last != EOF)
+			get();
+		return true;
+	}
+
+	std::string columnList()
+	{
+		if (columns.empty())
+			return "*";
+		std::string list;
+		for (auto &column : columns)
+			list += (list.empty() ? "" : ", ") + quoteIdentifier(column);
+		return list;
+	}
+
+	static bool isPlainIdentifier(const std::string &name)
+	{
+		if (name.empty() || !(isalpha((unsigned char)name[0]) || name[0] == '_'))
+			return false;
+		return std::all_of(name.begin(), name.end(), [](char c)
+						   { return isalnum((unsigned char)c) || c == '_'; });
+	}
+
+	/** a column name as is if it is a plain identifier, quoted otherwise, so the names of a file can not inject sql */
+	static std::string quoteIdentifier(const std::string &name)
+	{
+		if (isPlainIdentifier(name))
+			return name;
+		std::string quoted = "\"";
+		for (auto c : name)
+			quoted += c == '"' ? "\"\"" : std::string(1, c);
+		return quoted + "\"";
+	}
+
+public:
+	/** true if name is a table name, optionally schema qualified, of plain or quoted identifiers */
+	static bool isTableName(const std::string &name)
+	{
+		size_t i = 0;
+		for (;;)
+		{
+			if (i < name.size() && name[i] == '"')
+			{
+				// quoted identifier, embedded quotes are doubled
+				for (i++;; i += 2)
+				{
+					i = name.find('"', i);
+					if (i == std::string::npos)
+						return false;
+					if (i + 1 >= name.size() || name[i + 1] != '"')
+						break;
+				}
+				i++;
+			}
+			else
+			{
+				auto end = std::min(name.find('.', i), name.size());
+				if (!isPlainIdentifier(name.substr(i, end - i)))
+					return false;
+				i = end;
+			}
+			if (i == name.size())
+				return true;
+			if (name[i] != '.')
+				return false;
+			i++;
+		}
+	}
+};
+
+/** sha-256 of the ledger record and node hashes, tci has no hash function and node's openssl is not linkable on every platform */
+struct Sha256
+{
+	static const size_t SIZE = 32;
+
+	Sha256()
+	{
+		reset();
+	}
+
+	void reset()
+	{
+		static const uint32_t INITIAL[] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+		memcpy(state, INITIAL, sizeof(state));
+		length = 0;
+	}
+
+	void update(const void *data, size_t size)
+	{
+		auto bytes = (const uint8_t *)data;
+		while (size)
+		{
+			auto used = length % 64;
+			auto copied = std::min(size, (size_t)(64 - used));
+			memcpy(block + used, bytes, copied);
+			length += copied;
+			bytes += copied;
+			size -= copied;
+			if (length % 64 == 0)
+				compress();
+		}
+	}
+
+	void update(uint8_t byte)
+	{
+		update(&byte, 1);
+	}
+
+	void finish(uint8_t digest[SIZE])
+	{
+		uint64_t bits = length * 8;
+		update(0x80);
+		while (length % 64 != 56)
+			update(0x00);
+		for (int i = 7; i >= 0; i--)
+			update((uint8_t)(bits >> (i * 8)));
+		for (int i = 0; i < 8; i++)
+		{
+			for (int j = 0; j < 4; j++)
+				digest[i * 4 + j] = (uint8_t)(state[i] >> (24 - j * 8));
+		}
+		reset();
+	}
+
+	/** hash of two ledger nodes */
+	static std::string hashNodes(const std::string &first, const std::string &second)
+	{
+		Sha256 hash;
+		hash.update(0x01);
+		hash.update(first.data(), first.size());
+		hash.update(second.data(), second.size());
+		std::string digest(SIZE, '\0');
+		hash.finish((uint8_t *)&digest[0]);
+		return digest;
+	}
+
+private:
+	uint32_t state[8];
+	uint8_t block[64];
+	uint64_t length; // bytes hashed
+
+	static uint32_t rotate(uint32_t x, int n)
+	{
+		return (x >> n) | (x << (32 - n));
+	}
+
+	void compress()
+	{
+		static const uint32_t K[] = {
+			0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+			0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+			0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+			0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+			0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+			0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+			0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+			0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+		uint32_t w[64];
+		for (int i = 0; i < 16; i++)
+			w[i] = (uint32_t)block[i * 4] << 24 | (uint32_t)block[i * 4 + 1] << 16 | (uint32_t)block[i * 4 + 2] << 8 | block[i * 4 + 3];
+		for (int i = 16; i < 64; i++)
+		{
+			auto s0 = rotate(w[i - 15], 7) ^ rotate(w[i - 15], 18) ^ (w[i - 15] >> 3);
+			auto s1 = rotate(w[i - 2], 17) ^ rotate(w[i - 2], 19) ^ (w[i - 2] >> 10);
+			w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+		}
+		uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], h = state[7];
+		for (int i = 0; i < 64; i++)
+		{
+			auto t1 = h + (rotate(e, 6) ^ rotate(e, 11) ^ rotate(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+			auto t2 = (rotate(a, 2) ^ rotate(a, 13) ^ rotate(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+			h = g;
+			g = f;
+			f = e;
+			e = d + t1;
+			d = c;
+			c = b;
+			b = a;
+			a = t1 + t2;
+		}
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+		state[5] += f;
+		state[6] += g;
+		state[7] += h;
+	}
+};
+
+
+/**
+ * an audit or consistency proof of a transbase ledger, folded natively like TransbaseLedger.verifyAuditProof
+ * and verifyConsistencyProof of example/transbase-ledger.js. Hashes are raw bytes, empty if null.
+ */
+struct LedgerProof
+{
+	struct Step
+	{
+		std::string hash;
+		bool first = false;
+		bool old = false; // the node is part of the old ledger of a consistency proof
+		bool now = false; // the node is part of the new ledger of a consistency proof
+	};
+
+	bool consistency = false;
+	std::string record; // hash of the record of an audit proof
+	std::string ledger; // hash of the ledger, the new one of a consistency proof
+	std::string ledgerOld;
+	std::vector<Step> path;
+
+	/** convert {recordHash, ledgerHash, path} or {ledgerHashOld, ledgerHashNew, path}, hashes are Buffers or hex strings */
+	static LedgerProof from(Napi::Value value, bool consistency)
+	{
+		if (!value.IsObject())
+			throw Napi::TypeError::New(value.Env(), "a ledger proof must be an object");
+		auto object = value.As<Napi::Object>();
+		LedgerProof proof;
+		proof.consistency = consistency;
+		if (consistency)
+		{
+			proof.ledgerOld = toHash(object.Get("ledgerHashOld"));
+			proof.ledger = toHash(object.Get("ledgerHashNew"));
+		}
+		else
+		{
+			proof.record = toHash(object.Get("recordHash"));
+			proof.ledger = toHash(object.Get("ledgerHash"));
+		}
+		if (!object.Get("path").IsArray())
+			throw Napi::TypeError::New(value.Env(), "a ledger proof requires a path array");
+		auto path = object.Get("path").As<Napi::Array>();
+		for (uint32_t i = 0; i < path.Length(); i++)
+		{
+			if (!path.Get(i).IsObject())
+				throw Napi::TypeError::New(value.Env(), "a ledger proof path node must be an object");
+			auto node = path.Get(i).As<Napi::Object>();
+			Step step;
+			step.hash = toHash(node.Get("hash"));
+			step.first = node.Get("first").ToBoolean().Value();
+			step.old = !node.Get("old").IsNull() && !node.Get("old").IsUndefined();
+			step.now = !node.Get("new").IsNull() && !node.Get("new").IsUndefined();
+			proof.path.push_back(step);
+		}
+		return proof;
+	}
+
+	/** a sha-256 hash of 32 bytes, as Buffer or as hex string of 64 digits */
+	static std::string toHash(Napi::Value value)
+	{
+		if (value.IsBuffer())
+		{
+			auto buffer = value.As<Napi::Buffer<char>>();
+			if (buffer.Length() != Sha256::SIZE)
+				throw Napi::TypeError::New(value.Env(), "a ledger hash must be a Buffer or a hex string of 32 bytes");
+			return std::string(buffer.Data(), buffer.Length());
+		}
+		if (value.IsNull() || value.IsUndefined())
+			return "";
+		auto hex = value.ToString().Utf8Value();
+		if (hex.size() != 2 * Sha256::SIZE)
+			throw Napi::TypeError::New(value.Env(), "a ledger hash must be a Buffer or a hex string of 32 bytes");
+		std::string hash(Sha256::SIZE, '\0');
+		for (size_t i = 0; i < hash.size(); i++)
+		{
+			int high = Import::Target::hexDigit(hex[2 * i]), low = Import::Target::hexDigit(hex[2 * i + 1]);
+			if (high < 0 || low < 0)
+				throw Napi::TypeError::New(value.Env(), "a ledger hash must be a Buffer or a hex string of 32 bytes");
+			hash[i] = (char)(high << 4 | low);
+		}
+		return hash;
+	}
+
+	bool verify() const
+	{
+		if (!consistency)
+		{
+			auto hash = record;
+			for (auto &step : path)
+				hash = fold(hash, step);
+			return hash == ledger;
+		}
+		std::string hashOld, hashNew;
+		for (auto &step : path)
+		{
+			if (step.old)
+				hashOld = hashOld.empty() ? step.hash : fold(hashOld, step);
+			if (step.now)
+				hashNew = hashNew.empty() ? step.hash : fold(hashNew, step);
+		}
+		return hashOld == ledgerOld && hashNew == ledger;
+	}
+
+	static std::string fold(const std::string &hash, const Step &step)
+	{
+		return step.first ? Sha256::hashNodes(step.hash, hash) : Sha256::hashNodes(hash, step.hash);
+	}
+};
+
+/**
+ * verifies a slice of ledger proofs on the libuv threadpool.
+ * the proofs of a call are split into one slice per thread, the last slice to complete settles the promise.
+ */
+class LedgerWorker : public Napi::AsyncWorker
+{
+public:
+	struct Batch
+	{
+		std::vector<LedgerProof> proofs;
+		std::vector<uint8_t> valid;
+		size_t pending = 0; // slices not completed yet
+		bool failed = false;
+		Napi::Promise::Deferred deferred;
+
+		Batch(Napi::Env env) : deferred(Napi::Promise::Deferred::New(env))
+		{
+		}
+	};
+
+	LedgerWorker(Napi::Env env, std::shared_ptr<Batch> batch, size_t begin, size_t end)
+		: Napi::AsyncWorker(env), batch(batch), begin(begin), end(end)
+	{
+	}
+
+	void Execute() override
+	{
+		for (auto i = begin; i < end; i++)
+			batch->valid[i] = batch->proofs[i].verify();
+	}
+
+	void OnOK() override
+	{
+		if (--batch->pending || batch->failed)
+			return;
+		auto valid = Napi::Array::New(Env(), batch->valid.size());
+		for (uint32_t i = 0; i < batch->valid.size(); i++)
+			valid.Set(i, Napi::Boolean::New(Env(), batch->valid[i] != 0));
+		batch->deferred.Resolve(valid);
+	}
+
+	void OnError(const Napi::Error &e) override
+	{
+		batch->pending--;
+		if (!batch->failed)
+			batch->deferred.Reject(e.Value());
+		batch->failed = true;
+	}
+
+	static void Init(Napi::Env env, Napi::Object exports)
+	{
+		auto ledger = Napi::Object::New(env);
+		ledger.Set("verifyAuditProofs", Napi::Function::New(env, verifyAuditProofs));
+		ledger.Set("verifyConsistencyProofs", Napi::Function::New(env, verifyConsistencyProofs));
+		exports.Set("Ledger", ledger);
+	}
+
+	/**
+	 * verify audit proofs {recordHash, ledgerHash, path: [{hash, first}]}
+	 * @param threads optional number of worker threads, 4 by default
+	 * @returns a promise of the validity of every proof
+	 */
+	static Napi::Value verifyAuditProofs(const Napi::CallbackInfo &info)
+	{
+		return verify(info, false);
+	}
+
+	/** verify consistency proofs {ledgerHashOld, ledgerHashNew, path: [{hash, first, old, new}]}, @see verifyAuditProofs */
+	static Napi::Value verifyConsistencyProofs(const Napi::CallbackInfo &info)
+	{
+		return verify(info, true);
+	}
+
+private:
+	static const uint32_t THREADS = 4; // the default size of the libuv threadpool
+	std::shared_ptr<Batch> batch;
+	size_t begin;
+	size_t end;
+
+	static Napi::Value verify(const Napi::CallbackInfo &info, bool consistency)
+	{
+		auto env = info.Env();
+		if (!info[0].IsArray())
+			throw Napi::TypeError::New(env, "verifying ledger proofs requires an array of proofs");
+		auto proofs = info[0].As<Napi::Array>();
+		auto threads = info.Length() > 1 && info[1].IsNumber() ? std::max(1u, info[1].As<Napi::Number>().Uint32Value()) : THREADS;
+
+		auto batch = std::make_shared<Batch>(env);
+		for (uint32_t i = 0; i < proofs.Length(); i++)
+			batch->proofs.push_back(LedgerProof::from(proofs.Get(i), consistency));
+		batch->valid.resize(batch->proofs.size());
+		auto size = batch->proofs.size();
+		auto slices = std::max((size_t)1, std::min((size_t)threads, size));
+		batch->pending = slices;
+		for (size_t i = 0; i < slices; i++)
+			(new LedgerWorker(env, batch, size * i / slices, size * (i + 1) / slices))->Queue();
+		return batch->deferred.Promise();
+	}
+};
+
+
+/**
+ * bounded lru cache of prepared statements keyed by sql text.
+ * every entry owns its statement and result set handle, allocating and freeing them is up to the caller.
+ */
+struct StatementCache
+{
+	struct Entry
+	{
+		std::string sql;
+		TCIStatement *statement = NULL;
+		TCIResultSet *resultSet = NULL;
+		BindPlan plan{};
+		std::shared_ptr<Description> description{}; // empty until the first execution is described
+	};
+
+	std::list<Entry> entries; // most recently used first
+	std::unordered_map<std::string, std::list<Entry>::iterator> index;
+	size_t capacity = 16;
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	uint64_t evictions = 0;
+
+	/** lookup a statement and mark it as most recently used, returns NULL if not cached */
+	Entry *get(const std::string &sql)
+	{
+		auto it = index.find(sql);
+		if (it == index.end())
+		{
+			misses++;
+			return NULL;
+		}
+		hits++;
+		entries.splice(entries.begin(), entries, it->second);
+		return &entries.front();
+	}
+
+	Entry *put(Entry entry)
+	{
+		entries.push_front(entry);
+		index[entry.sql] = entries.begin();
+		return &entries.front();
+	}
+
+	bool isFull()
+	{
+		return entries.size() >= capacity;
+	}
+
+	/** remove the least recently used statement, its handles have to be freed by the caller */
+	Entry evict()
+	{
+		auto entry = entries.back();
+		index.erase(entry.sql);
+		entries.pop_back();
+		evictions++;
+		return entry;
+	}
+};
+
+/**
+ * client side cache of select results keyed by sql text, typeCast and parameters.
+ * The rows are kept in the compact column buffers they were fetched into instead of js objects.
+ * Entries expire after ttl, the least recently used ones are evicted to stay within maxBytes.
+ */
+struct ResultCache
+{
+	struct Entry
+	{
+		std::string key;
+		std::vector<std::string> tables; // referenced tables in lower case, unknown if empty
+		std::shared_ptr<Description> description;
+		std::vector<ColumnBuffer> columns;
+		uint32_t length = 0;
+		size_t bytes = 0;
+		std::chrono::steady_clock::time_point expires;
+	};
+
+	std::list<std::shared_ptr<Entry>> entries; // most recently used first
+	std::unordered_map<std::string, std::list<std::shared_ptr<Entry>>::iterator> index;
+	size_t maxBytes = 16 * 1024 * 1024;
+	uint32_t maxRows = 10000; // larger results are not cached
+	double ttl = 1000;		  // milliseconds
+	size_t bytes = 0;
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	uint64_t evictions = 0;
+	uint64_t expirations = 0;
+	uint64_t invalidations = 0;
+
+	/** lookup a result and mark it as most recently used, returns an empty pointer if not cached or expired */
+	std::shared_ptr<Entry> get(const std::string &key)
+	{
+		auto it = index.find(key);
+		if (it == index.end())
+		{
+			misses++;
+			return nullptr;
+		}
+		if (std::chrono::steady_clock::now() >= (*it->second)->expires)
+		{
+			remove(it->second);
+			expirations++;
+			misses++;
+			return nullptr;
+		}
+		hits++;
+		entries.splice(entries.begin(), entries, it->second);
+		return entries.front();
+	}
+
+	/** cache a result unless it is larger than maxBytes, the least recently used ones are evicted to make room */
+	bool put(std::shared_ptr<Entry> entry)
+	{
+		if (entry->bytes > maxBytes)
+			return false;
+		auto it = index.find(entry->key);
+		if (it != index.end())
+			remove(it->second);
+		while (bytes + entry->bytes > maxBytes)
+		{
+			remove(std::prev(entries.end()));
+			evictions++;
+		}
+		entry->expires = std::chrono::steady_clock::now() + std::chrono::microseconds((int64_t)(ttl * 1000));
+		entries.push_front(entry);
+		index[entry->key] = entries.begin();
+		bytes += entry->bytes;
+		return true;
+	}
+
+	/** remove the results referencing one of the tables, all results if tables is empty */
+	void invalidate(const std::vector<std::string> &tables)
+	{
+		for (auto it = entries.begin(); it != entries.end();)
+		{
+			auto current = it++;
+			if (tables.empty() || references(**current, tables))
+			{
+				remove(current);
+				invalidations++;
+			}
+		}
+	}
+
+	/** true if the entry references one of the tables, an entry with unknown tables references all */
+	static bool references(const Entry &entry, const std::vector<std::string> &tables)
+	{
+		if (entry.tables.empty())
+			return true;
+		for (auto &table : tables)
+		{
+			if (std::find(entry.tables.begin(), entry.tables.end(), table) != entry.tables.end())
+				return true;
+		}
+		return false;
+	}
+
+	void remove(std::list<std::shared_ptr<Entry>>::iterator it)
+	{
+		bytes -= (*it)->bytes;
+		index.erase((*it)->key);
+		entries.erase(it);
+	}
+
+	void clear()
+	{
+		entries.clear();
+		index.clear();
+		bytes = 0;
+	}
+};
+
+/**
+ * log-linear histogram of durations in nanoseconds with 8 buckets per power of two,
+ * so recorded values are reported with a relative error below 12.5%
+ */
+struct Histogram
+{
+	static const int SUB_BUCKETS = 8;
+
+	uint64_t counts[62 * SUB_BUCKETS] = {};
+	uint64_t count = 0;
+	uint64_t sum = 0;
+	uint64_t min = UINT64_MAX;
+	uint64_t max = 0;
+
+	void record(uint64_t value)
+	{
+		counts[index(value)]++;
+		count++;
+		sum += value;
+		min = std::min(min, value);
+		max = std::max(max, value);
+	}
+
+	/** the upper bound of the bucket that contains the given percentile (0..100) */
+	uint64_t percentile(double percentile)
+	{
+		auto rank = (uint64_t)std::ceil(percentile / 100 * count);
+		uint64_t seen = 0;
+		for (int i = 0; i < 62 * SUB_BUCKETS; i++)
+		{
+			seen += counts[i];
+			if (seen >= rank && seen > 0)
+				return std::min(upperBound(i), max);
+		}
+		return max;
+	}
+
+	static int index(uint64_t value)
+	{
+		if (value < SUB_BUCKETS)
+			return (int)value;
+		int exponent = 0;
+		while ((value >> exponent) >= 2 * SUB_BUCKETS)
+			exponent++;
+		return (exponent + 1) * SUB_BUCKETS + (int)((value >> exponent) - SUB_BUCKETS);
+	}
+
+	static uint64_t upperBound(int index)
+	{
+		if (index < SUB_BUCKETS)
+			return index;
+		int exponent = index / SUB_BUCKETS - 1;
+		uint64_t subBucket = index % SUB_BUCKETS;
+		return ((SUB_BUCKETS + subBucket + 1) << exponent) - 1;
+	}
+
+	/** summary in milliseconds */
+	Napi::Object toJs(Napi::Env env)
+	{
+		auto ms = [](uint64_t ns)
+		{ return ns / 1e6; };
+		auto summary = Napi::Object::New(env);
+		summary.Set("count", (double)count);
+		summary.Set("min", count ? ms(min) : 0);
+		summary.Set("max", ms(max));
+		summary.Set("mean", count ? ms(sum) / count : 0);
+		summary.Set("p50", ms(percentile(50)));
+		summary.Set("p90", ms(percentile(90)));
+		summary.Set("p99", ms(percentile(99)));
+		summary.Set("total", ms(sum));
+		return summary;
+	}
+};
+
+/**
+ * latency histograms and counters of a connection. They are recorded on the main or a worker thread,
+ * nothing is recorded (not even the clock is read) while disabled.
+ */
+struct Stats
+{
+	bool enabled = false;
+	std::mutex mutex;
+	Histogram prepare;
+	Histogram execute;
+	Histogram firstRow; // the first fetch of a query
+	Histogram fetch;	// all fetches of a query
+	Histogram convert;	// conversion of fetched values to js
+	uint64_t queries = 0;
+	uint64_t rows = 0;
+	uint64_t bytes = 0;	   // string and binary bytes converted
+	uint64_t lobBytes = 0; // bytes of chunked reads and uploads
+	std::unordered_map<std::string, uint64_t> errors; // by sqlcode
+
+	// the query currently fetching
+	bool fetching = false;
+	bool firstFetch = false;
+	uint64_t fetchTime = 0;
+	// counted without locking by the thread running the calls of the connection, published at once by flush
+	uint64_t pendingRows = 0;
+	uint64_t pendingBytes = 0;
+	uint64_t pendingConvert = 0; // conversion time of the cells read since the last flush
+
+	static uint64_t now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	/** measures the lifetime of a scope into a histogram */
+	struct Timer
+	{
+		Stats &stats;
+		Histogram &histogram;
+		uint64_t start;
+
+		Timer(Stats &stats, Histogram &histogram) : stats(stats), histogram(histogram), start(stats.enabled ? now() : 0)
+		{
+		}
+
+		~Timer()
+		{
+			if (start)
+				stats.record(histogram, now() - start);
+		}
+	};
+
+	void record(Histogram &histogram, uint64_t duration)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		histogram.record(duration);
+	}
+
+	void count(uint64_t &counter, uint64_t value)
+	{
+		if (!enabled)
+			return;
+		std::lock_guard<std::mutex> lock(mutex);
+		counter += value;
+	}
+
+	/** count into a pending counter, e.g. per cell, it is published with the fetch or batch by flush */
+	void accumulate(uint64_t &pending, uint64_t value)
+	{
+		if (enabled)
+			pending += value;
+	}
+
+	/** publish the pending counts of the current fetch or batch under the mutex */
+	void flush()
+	{
+		if (!pendingRows && !pendingBytes && !pendingConvert)
+			return;
+		std::lock_guard<std::mutex> lock(mutex);
+		rows += pendingRows;
+		bytes += pendingBytes;
+		if (pendingConvert)
+			convert.record(pendingConvert);
+		pendingRows = pendingBytes = pendingConvert = 0;
+	}
+
+	/** a statement was executed, its first fetch is recorded as first row */
+	void beginQuery()
+	{
+		if (!enabled)
+			return;
+		endQuery();
+		std::lock_guard<std::mutex> lock(mutex);
+		queries++;
+		fetching = true;
+		firstFetch = true;
+		fetchTime = 0;
+	}
+
+	void recordFetch(uint64_t duration, bool found)
+	{
+		if (firstFetch)
+			record(firstRow, duration);
+		firstFetch = false;
+		fetchTime += duration;
+		if (found)
+			pendingRows++;
+	}
+
+	/** the result set is done or replaced, record the fetch time of the whole query */
+	void endQuery()
+	{
+		flush();
+		std::lock_guard<std::mutex> lock(mutex);
+		if (fetching && !firstFetch)
+			fetch.record(fetchTime);
+		fetching = false;
+	}
+
+	void error(const char *sqlcode, size_t size)
+	{
+		if (!enabled)
+			return;
+		std::lock_guard<std::mutex> lock(mutex);
+		errors[std::string(sqlcode, strnlen(sqlcode, size))]++;
+	}
+
+	void reset()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		prepare = Histogram();
+		execute = Histogram();
+		firstRow = Histogram();
+		fetch = Histogram();
+		convert = Histogram();
+		queries = rows = bytes = lobBytes = 0;
+		errors.clear();
+	}
+
+	Napi::Object toJs(Napi::Env env)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto stats = Napi::Object::New(env);
+		stats.Set("enabled", enabled);
+		stats.Set("queries", (double)queries);
+		stats.Set("rows", (double)rows);
+		stats.Set("bytes", (double)bytes);
+		stats.Set("lobBytes", (double)lobBytes);
+		stats.Set("prepare", prepare.toJs(env));
+		stats.Set("execute", execute.toJs(env));
+		stats.Set("firstRow", firstRow.toJs(env));
+		stats.Set("fetch", fetch.toJs(env));
+		stats.Set("convert", convert.toJs(env));
+		auto errorsBySqlcode = Napi::Object::New(env);
+		for (auto &error : errors)
+			errorsBySqlcode.Set(error.first, (double)error.second);
+		stats.Set("errors", errorsBySqlcode);
+		return stats;
+	}
+};
+
+/**
+ * a tci environment that can be shared by several connections, e.g. of a connection pool.
+ * it is freed when neither the js object nor any connection refers to it anymore.
+ */
+class Environment : public Napi::ObjectWrap<Environment>
+{
+public:
+	std::shared_ptr<TCIEnvironment> environment;
+
+	Environment(const Napi::CallbackInfo &info) : Napi::ObjectWrap<Environment>(info)
+	{
+		Char errorMessage[1000];
+		if (alloc(environment, errorMessage, sizeof(errorMessage)))
+			throw Napi::Error::New(info.Env(), errorMessage);
+	}
+
+	static Napi::Function Init(Napi::Env env, Napi::Object exports)
+	{
+		auto environment = DefineClass(env, "Environment", std::vector<PropertyDescriptor>());
+		exports.Set("Environment", environment);
+		return environment;
+	}
+
+	static TCIState alloc(std::shared_ptr<TCIEnvironment> &environment, Char *errorMessage, Int4 size)
+	{
+		TCIEnvironment *allocated = NULL;
+		TCIState state = TCIAllocEnvironment(&allocated);
+		if (state)
+		{
+			TCIGetEnvironmentError(allocated, 1, errorMessage, size, NULL, NULL);
+			if (allocated)
+				TCIFreeEnvironment(allocated);
+			return state;
+		}
+		environment = std::shared_ptr<TCIEnvironment>(allocated, TCIFreeEnvironment);
+		return state;
+	}
+};
+
+/** the handles of a logged in connection, owned by a TCI or idle in a SharedPool */
+struct Session
+{
+	std::shared_ptr<TCIEnvironment> environment;
+	TCIError *error = NULL;
+	TCIConnection *connection = NULL;
+	TCITransaction *transaction = NULL;
+	TCIStatement *directStatement = NULL;
+	TCIResultSet *directResultSet = NULL;
+	StatementCache statements; // prepared statements of the connection, they move with it
+
+	/** free all handles and log out */
+	void close()
+	{
+		for (auto &entry : statements.entries)
+		{
+			if (entry.resultSet)
+			{
+				TCIClose(entry.resultSet);
+				TCIFreeResultSet(entry.resultSet);
+			}
+			if (entry.statement)
+				TCIFreeStatement(entry.statement);
+		}
+		statements.entries.clear();
+		statements.index.clear();
+		if (directResultSet)
+		{
+			TCIClose(directResultSet);
+			TCIFreeResultSet(directResultSet);
+			directResultSet = NULL;
+		}
+		if (directStatement)
+		{
+			TCIFreeStatement(directStatement);
+			directStatement = NULL;
+		}
+		if (transaction)
+		{
+			TCIFreeTransaction(transaction);
+			transaction = NULL;
+		}
+		if (connection)
+		{
+			TCILogout(connection);
+			TCIDisconnect(connection);
+			TCIFreeConnection(connection);
+			connection = NULL;
+		}
+		if (error)
+		{
+			TCIFreeError(error);
+			error = NULL;
+		}
+		environment.reset(); // freed with its last connection if shared
+	}
+};
+
+/**
+ * a process-wide pool of sessions, registered by name and shared by the connections of every thread of the process,
+ * e.g. of worker_threads. A connection borrows an idle session or logs in a new one as long as fewer than max sessions
+ * are borrowed, and gives it back when it is closed. The sessions share one tci environment.
+ */
+class SharedPool
+{
+public:
+	std::string url;
+	std::string user;
+	std::string password;
+	std::shared_ptr<TCIEnvironment> environment;
+	size_t max = 4;
+
+	enum Acquired
+	{
+		NONE, // all max sessions are borrowed
+		IDLE, // an idle session is moved into session
+		LOGIN // no session is idle but one may be logged in, it is counted as borrowed already
+	};
+
+	/**
+	 * borrow an idle session without waiting, a worker thread must not block while all sessions are borrowed.
+	 * Callers wait for a session given back on their own event loop, @see Transbase.borrow
+	 */
+	Acquired acquire(Session &session)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (closed)
+			throw std::runtime_error("shared pool is closed");
+		if (idle.empty() && borrowed >= max)
+			return NONE;
+		borrowed++;
+		if (idle.empty())
+			return LOGIN;
+		session = std::move(idle.back());
+		idle.pop_back();
+		return IDLE;
+	}
+
+	/** give a borrowed session back, it is closed if the pool is */
+	void release(Session session)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			borrowed--;
+			if (!closed)
+			{
+				idle.push_back(std::move(session));
+				session = Session();
+			}
+		}
+		session.close();
+	}
+
+	/** a session counted as borrowed by acquire could not be logged in */
+	void abandon()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		borrowed--;
+	}
+
+	Napi::Object stats(Napi::Env env)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto stats = Napi::Object::New(env);
+		stats.Set("max", max);
+		stats.Set("borrowed", borrowed);
+		stats.Set("idle", idle.size());
+		return stats;
+	}
+
+	/** the registered pool of name, an empty pointer if there is none */
+	static std::shared_ptr<SharedPool> get(const std::string &name)
+	{
+		auto &pools = registry();
+		std::lock_guard<std::mutex> lock(pools.mutex);
+		auto it = pools.byName.find(name);
+		return it == pools.byName.end() ? nullptr : it->second;
+	}
+
+	static void Init(Napi::Env env, Napi::Object exports)
+	{
+		auto shared = Napi::Object::New(env);
+		shared.Set("register", Napi::Function::New(env, registerPool));
+		shared.Set("unregister", Napi::Function::New(env, unregisterPool));
+		shared.Set("getStats", Napi::Function::New(env, getStats));
+		exports.Set("SharedPool", shared);
+	}
+
+	/**
+	 * register a pool {url, user, password, max = 4} under name, visible to every thread of the process.
+	 * No session is logged in until the first one is borrowed.
+	 */
+	static void registerPool(const Napi::CallbackInfo &info)
+	{
+		auto env = info.Env();
+		auto name = info[0].ToString().Utf8Value();
+		if (!info[1].IsObject())
+			throw Napi::TypeError::New(env, "registering a shared pool requires a config {url,user,password}");
+		auto config = info[1].As<Napi::Object>();
+		auto pool = std::make_shared<SharedPool>();
+		pool->url = config.Get("url").ToString().Utf8Value();
+		pool->user = config.Get("user").ToString().Utf8Value();
+		pool->password = config.Get("password").ToString().Utf8Value();
+		if (config.Get("max").IsNumber())
+			pool->max = std::max(1u, config.Get("max").As<Napi::Number>().Uint32Value());
+		Char errorMessage[1000];
+		if (Environment::alloc(pool->environment, errorMessage, sizeof(errorMessage)))
+			throw Napi::Error::New(env, errorMessage);
+
+		auto &pools = registry();
+		std::lock_guard<std::mutex> lock(pools.mutex);
+		if (pools.byName.count(name))
+			throw Napi::Error::New(env, "a shared pool named " + name + " is registered already");
+		pools.byName[name] = pool;
+	}
+
+	/** remove a pool, its idle sessions are closed now and borrowed ones when they are given back */
+	static Napi::Value unregisterPool(const Napi::CallbackInfo &info)
+	{
+		auto name = info[0].ToString().Utf8Value();
+		std::shared_ptr<SharedPool> pool;
+		{
+			auto &pools = registry();
+			std::lock_guard<std::mutex> lock(pools.mutex);
+			auto it = pools.byName.find(name);
+			if (it == pools.byName.end())
+				return Napi::Boolean::New(info.Env(), false);
+			pool = it->second;
+			pools.byName.erase(it);
+		}
+		pool->close();
+		return Napi::Boolean::New(info.Env(), true);
+	}
+
+	/** {max, borrowed, idle} sessions of a pool, undefined if it is not registered */
+	static Napi::Value getStats(const Napi::CallbackInfo &info)
+	{
+		auto pool = get(info[0].ToString().Utf8Value());
+		return pool ? pool->stats(info.Env()) : info.Env().Undefined();
+	}
+
+private:
+	std::mutex mutex;
+	std::vector<Session> idle;
+	size_t borrowed = 0;
+	bool closed = false;
+
+	struct Registry
+	{
+		std::mutex mutex;
+		std::unordered_map<std::string, std::shared_ptr<SharedPool>> byName;
+	};
+
+	/** the pools of the process, the addon is loaded once per process but initialized per thread */
+	static Registry &registry()
+	{
+		static Registry pools;
+		return pools;
+	}
+
+	void close()
+	{
+		std::vector<Session> closing;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			closed = true;
+			closing.swap(idle);
+		}
+		for (auto &session : closing)
+			session.close();
+	}
+};
+
+/**
+ * cancels the running tci call of a connection from another thread, when its deadline passed or on an abort from js.
+ * TCICancel is the one tci call allowed concurrently to a running one.
+ */
+struct Cancellation
+{
+	enum Reason
+	{
+		NONE,
+		TIMEOUT,
+		ABORT,
+	};
+
+	/** deadline of an execution and of reading its result set */
+	struct Limit
+	{
+		std::chrono::steady_clock::time_point deadline;
+		uint32_t timeout = 0; // milliseconds, 0 if there is no deadline
+	};
+
+	std::atomic<int> reason{NONE};				// why the current execution was cancelled, reset by the next one
+	std::atomic<TCIResultSet *> running{NULL};  // result set of the running call
+	Limit limit;								// of the current execution
+	bool reset = false;							// reset by js for the next execution, an abort until it begins is pending
+
+	/** cancel the running call, all further calls of the execution fail with the first reason */
+	void cancel(Reason why)
+	{
+		int none = NONE;
+		reason.compare_exchange_strong(none, why);
+		if (auto resultSet = running.load())
+			TCICancel(resultSet);
+	}
+
+	bool expired() const
+	{
+		return limit.timeout && std::chrono::steady_clock::now() >= limit.deadline;
+	}
+};
+
+/** a cancelled call on a worker thread, rejected as TimeoutError or AbortError on the main thread */
+struct Cancelled : std::runtime_error
+{
+	Cancellation::Reason reason;
+
+	Cancelled(Cancellation::Reason reason, const std::string &message) : std::runtime_error(message), reason(reason)
+	{
+	}
+};
+
+/**
+ * cancels the running calls whose deadline passed. It has a thread of its own, so it also interrupts
+ * synchronous calls blocking the js thread. There is one per process, started with the first deadline.
+ */
+class Watchdog
+{
+public:
+	static Watchdog &get()
+	{
+		static Watchdog *watchdog = new Watchdog(); // never destroyed, its thread waits until the process exits
+		return *watchdog;
+	}
+
+	void watch(Cancellation *cancellation)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!started)
+		{
+			std::thread(&Watchdog::run, this).detach();
+			started = true;
+		}
+		watched[cancellation] = cancellation->limit.deadline;
+		changed.notify_one();
+	}
+
+	/** stop watching, a cancellation in progress is completed first */
+	void unwatch(Cancellation *cancellation)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		watched.erase(cancellation);
+	}
+
+private:
+	std::mutex mutex;
+	std::condition_variable changed;
+	std::unordered_map<Cancellation *, std::chrono::steady_clock::time_point> watched;
+	bool started = false;
+
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		for (;;)
+		{
+			if (watched.empty())
+			{
+				changed.wait(lock);
+				continue;
+			}
+			auto next = std::min_element(watched.begin(), watched.end(), [](const auto &a, const auto &b)
+										 { return a.second < b.second; });
+			if (std::chrono::steady_clock::now() < next->second)
+			{
+				changed.wait_until(lock, next->second);
+				continue;
+			}
+			next->first->cancel(Cancellation::TIMEOUT);
+			watched.erase(next);
+		}
+	}
+};
+
+/**
+ * makes a call on a result set cancellable while it is in scope and has the Watchdog watch its deadline.
+ * Nested calls, e.g. the fetches of a batch, are covered by the outermost.
+ */
+class Cancellable
+{
+public:
+	Cancellable(Cancellation &cancellation, TCIResultSet *resultSet)
+		: cancellation(cancellation), outer(!cancellation.running.load(std::memory_order_relaxed))
+	{
+		if (!outer)
+			return;
+		cancellation.running = resultSet;
+		if (cancellation.expired())
+			cancellation.cancel(Cancellation::TIMEOUT);
+		else if (cancellation.limit.timeout)
+			Watchdog::get().watch(&cancellation);
+	}
+
+	~Cancellable()
+	{
+		if (!outer)
+			return;
+		if (cancellation.limit.timeout)
+			Watchdog::get().unwatch(&cancellation);
+		cancellation.running = NULL;
+	}
+
+private:
+	Cancellation &cancellation;
+	bool outer;
+};
+
+/** statement and result set handles of a cursor, recycled by the HandlePool of their connection */
+struct Handles
+{
+	TCIStatement *statement = NULL;
+	TCIResultSet *resultSet = NULL;
+	std::string sql; // last prepared query, prepared again only if the cursor runs another one
+	BindPlan plan;
+	std::shared_ptr<Description> description;
+	TCIState state = TCI_SUCCESS;		// state of the last call on these handles
+	Cancellation::Limit limit;			// of the last execution on these handles
+	int cancelled = Cancellation::NONE;	// why the last execution was cancelled
+	bool released = false;				// the cursor was closed while its handles were selected
+
+	/** forget the prepared query */
+	void reset()
+	{
+		sql.clear();
+		plan = BindPlan();
+		description.reset();
+	}
+
+	void free()
+	{
+		if (resultSet)
+		{
+			TCIClose(resultSet);
+			TCIFreeResultSet(resultSet);
+		}
+		if (statement)
+			TCIFreeStatement(statement);
+		resultSet = NULL;
+		statement = NULL;
+	}
+};
+
+/**
+ * the cursor handles of a connection. Released handles are kept for reuse, all are freed with the connection.
+ * it is shared with the cursors, so they can release their handles regardless of the finalization order.
+ */
+struct HandlePool
+{
+	static const size_t MAX_IDLE = 8;
+	std::vector<std::shared_ptr<Handles>> idle;
+	std::vector<std::weak_ptr<Handles>> allocated;
+	std::vector<std::shared_ptr<Handles>> pending; // released while busy, closed when the connection is idle again
+	bool closed = false;
+	bool busy = false; // a worker runs tci calls on the connection, handles must not be closed meanwhile
+
+	std::shared_ptr<Handles> acquire()
+	{
+		if (idle.empty())
+			return NULL;
+		auto handles = idle.back();
+		idle.pop_back();
+		return handles;
+	}
+
+	void add(std::shared_ptr<Handles> handles)
+	{
+		allocated.erase(std::remove_if(allocated.begin(), allocated.end(), [](std::weak_ptr<Handles> &it)
+									   { return it.expired(); }),
+						allocated.end());
+		allocated.push_back(handles);
+	}
+
+	void release(std::shared_ptr<Handles> handles)
+	{
+		if (closed || !handles->statement)
+			return; // freed with the connection
+		if (busy)
+		{
+			// e.g. a cursor finalized by the gc while another one runs a query
+			handles->released = true;
+			pending.push_back(handles);
+			return;
+		}
+		TCIClose(handles->resultSet);
+		if (idle.size() < MAX_IDLE)
+		{
+			handles->reset();
+			handles->state = TCI_SUCCESS;
+			handles->released = false;
+			idle.push_back(handles);
+		}
+		else
+			handles->free();
+	}
+
+	/** release the handles of cursors closed while the connection was busy */
+	void drain()
+	{
+		auto released = std::move(pending);
+		pending.clear();
+		for (auto &handles : released)
+			release(handles);
+	}
+
+	/** free all handles, also those of open cursors */
+	void close()
+	{
+		pending.clear();
+		for (auto &it : allocated)
+		{
+			auto handles = it.lock();
+			if (handles)
+				handles->free();
+		}
+		allocated.clear();
+		idle.clear();
+		closed = true;
+	}
+};
+
+/**
+ * a cursor of a connection with its own statement and result set handles,
+ * so its result set stays open while other queries run on the connection.
+ * the handles are given back to the connection by TCI::closeCursor or when the cursor is garbage collected.
+ */
+class Cursor : public Napi::ObjectWrap<Cursor>
+{
+public:
+	std::shared_ptr<HandlePool> pool;
+	std::shared_ptr<Handles> handles;
+
+	Cursor(const Napi::CallbackInfo &info) : Napi::ObjectWrap<Cursor>(info)
+	{
+	}
+
+	~Cursor()
+	{
+		release();
+	}
+
+	static Napi::Function Init(Napi::Env env, Napi::Object exports)
+	{
+		auto cursor = DefineClass(env, "Cursor", std::vector<PropertyDescriptor>());
+		exports.Set("Cursor", cursor);
+		return cursor;
+	}
+
+	void release()
+	{
+		if (!handles)
+			return;
+		if (handles.use_count() > 1)
+			handles->released = true; // still selected by the connection, which releases them when done
+		else
+			pool->release(handles);
+		handles.reset();
+	}
+};
+
+/**
+ * data of the addon per node environment, i.e. per main or worker thread that loads it.
+ * Everything else shared is immutable or process-wide and synchronized, @see SharedPool
+ */
+struct Addon
+{
+	Napi::FunctionReference environment;
+	Napi::FunctionReference cursor;
+	Napi::FunctionReference timeoutError; // js classes of cancelled calls, new(message, timeout)
+	Napi::FunctionReference abortError;
+
+#if NAPI_VERSION > 5
+	/** set the classes of the errors of cancelled calls, @see TCI::cancelError */
+	static void setErrorClasses(const Napi::CallbackInfo &info)
+	{
+		auto addon = info.Env().GetInstanceData<Addon>();
+		addon->timeoutError = Napi::Persistent(info[0].As<Napi::Function>());
+		addon->abortError = Napi::Persistent(info[1].As<Napi::Function>());
+	}
+#endif
+
+	/** the native object of value if it is an instance of the class of this environment, NULL otherwise */
+	template <typename T>
+	static T *unwrap(Napi::Value value, Napi::FunctionReference Addon::*constructor)
+	{
+		if (!value.IsObject())
+			return NULL;
+#if NAPI_VERSION > 5
+		auto addon = value.Env().GetInstanceData<Addon>();
+		if (!value.As<Napi::Object>().InstanceOf((addon->*constructor).Value()))
+			return NULL;
+#endif
+		return T::Unwrap(value.As<Napi::Object>());
+	}
+};
+
+/**
+ * node-api tci wrapper
+ */
+class TCI : public Napi::ObjectWrap<TCI>
+{
+private:
+	TCIState state = TCI_SUCCESS;
+	TCIError *error = NULL;
+	std::shared_ptr<TCIEnvironment> environment; // own or shared with other connections
+	TCIConnection *connection = NULL;
+	TCITransaction *transaction = NULL;
+	TCIStatement *directStatement = NULL; // used by executeDirect and uncached prepare
+	TCIResultSet *directResultSet = NULL;
+	TCIStatement *statement = NULL; // handles of the current query, either direct or cached
+	TCIResultSet *resultSet = NULL;
+	StatementCache statements;
+	ResultCache results;
+	std::shared_ptr<SharedPool> sharedPool; // the pool the session is borrowed from, if it is
+	Char sqlcode[5];
+	TBErrorCode errorCode;
+	Char errorMessage[1000];
+	short isNull;
+	Napi::Env env;
+	bool typeCast = true;
+	bool internStrings = false; // reuse js strings of repeated values within a fetched batch
+	Temporal::Cast dateCast = Temporal::STRING;
+	bool busy = false;	// an async worker owns the handles, set and cleared on the main thread only
+	bool offThread = false; // tci calls are running on a worker thread, no js access allowed
+	std::vector<char> scratch;						 // reused native buffer of chunked reads
+	std::unordered_map<std::string, BindValue> lobs; // large parameters appended chunk by chunk
+	BindPlan directPlan;							 // bind plan of an uncached prepared statement
+	BindPlan *plan = &directPlan;					 // bind plan of the current statement
+	Stats stats;
+	Cancellation cancellation;
+
+	/**
+	 * runs tci calls on the libuv threadpool and settles a promise on the main thread.
+	 * the connection is marked busy until the worker completes.
+	 */
+	class Worker : public Napi::AsyncWorker
+	{
+	public:
+		Worker(TCI *tci, std::function<void()> work, std::function<Napi::Value()> complete)
+			: Napi::AsyncWorker(tci->env), tci(tci), deferred(Napi::Promise::Deferred::New(tci->env)), work(work), complete(complete)
+		{
+			self = Napi::Persistent(tci->Value()); // keep the wrapper alive while running
+			tci->busy = tci->handlePool->busy = true;
+		}
+
+		Napi::Promise Promise()
+		{
+			return deferred.Promise();
+		}
+
+		void Execute() override
+		{
+			tci->offThread = true;
+			try
+			{
+				work();
+			}
+			catch (const Cancelled &e)
+			{
+				cancelled = e.reason;
+				SetError(e.what());
+			}
+			catch (const std::exception &e)
+			{
+				SetError(e.what());
+			}
+			tci->offThread = false;
+		}
+
+		void OnOK() override
+		{
+			tci->busy = tci->handlePool->busy = false;
+			try
+			{
+				auto result = complete ? complete() : Env().Undefined();
+				tci->restoreHandles();
+				deferred.Resolve(result);
+			}
+			catch (const Napi::Error &e)
+			{
+				tci->restoreHandles();
+				deferred.Reject(e.Value());
+			}
+		}
+
+		void OnError(const Napi::Error &e) override
+		{
+			tci->busy = tci->handlePool->busy = false;
+			auto error = cancelled ? tci->cancelError(cancelled, e.Message()) : e;
+			tci->restoreHandles();
+			deferred.Reject(error.Value());
+		}
+
+	private:
+		TCI *tci;
+		Cancellation::Reason cancelled = Cancellation::NONE;
+		Napi::ObjectReference self;
+		Napi::Promise::Deferred deferred;
+		std::function<void()> work;
+		std::function<Napi::Value()> complete;
+	};
+
+	std::shared_ptr<Description> directDescription;					// description of the direct statement
+	std::shared_ptr<Description> *description = &directDescription; // description of the current statement, empty until described
+	std::shared_ptr<Description> jsDescription;						// description the cached js values were created for
+	std::shared_ptr<HandlePool> handlePool = std::make_shared<HandlePool>();
+	std::shared_ptr<Handles> cursor; // handles of the selected cursor, empty if the connection's own are used
+	/** the connection's own handles while a cursor is selected */
+	struct
+	{
+		TCIStatement *statement;
+		TCIResultSet *resultSet;
+		BindPlan *plan;
+		std::shared_ptr<Description> *description;
+		TCIState state;
+		Cancellation::Limit limit;
+		int cancelled;
+	} saved;
+	std::vector<Napi::Reference<Napi::String>> columnKeys;			// js property keys of the columns
+	Napi::ObjectReference jsColumns;								// js column descriptors returned by describe
+
+	/**
+	 * rows of an executeBatch call, converted on the main thread so they can be executed on a worker.
+	 * the values are stored flat row after row, the string and buffer data of all rows in a single buffer.
+	 */
+	struct Batch
+	{
+		/** a converted parameter value, strings and buffers are stored at offset of bytes */
+		struct Cell
+		{
+			Int2 type;
+			Int2 isNull;
+			Int4 size;
+			union
+			{
+				Int8 int8;
+				double float8;
+				size_t offset;
+			};
+		};
+
+		std::string sql;
+		BindPlan plan;			 // parameter names and types, inferred from the first row
+		std::vector<Cell> cells; // plan.values.size() cells per row
+		std::string bytes;
+		size_t rowCount = 0;
+		size_t chunkSize = 1000;
+		bool transactional = true;
+		uint32_t timeout = 0; // milliseconds for all rows, 0 if there is no deadline
+		// result
+		std::vector<Int4> counts;
+		int64_t failedIndex = -1;
+		std::string error;
+		int cancelled = Cancellation::NONE; // why the batch was cancelled
+
+		/** copy a value converted by the plan */
+		void add(BindValue &value)
+		{
+			Cell cell;
+			cell.type = value.type;
+			cell.isNull = value.isNull;
+			if (value.type == TCI_C_CHAR || value.type == TCI_C_BYTE)
+			{
+				size_t length = value.isNull ? 0 : value.bytes.size(); // a null keeps the storage of the previous string
+				cell.offset = bytes.size();
+				cell.size = (Int4)length + (value.type == TCI_C_CHAR ? 1 : 0);
+				bytes.append(value.bytes.data(), length);
+				if (value.type == TCI_C_CHAR)
+					bytes.push_back('\0');
+			}
+			else
+			{
+				cell.size = value.size();
+				cell.int8 = value.int8;
+			}
+			cells.push_back(cell);
+		}
+
+		void *data(Cell &cell)
+		{
+			return cell.type == TCI_C_CHAR || cell.type == TCI_C_BYTE ? (void *)&bytes[cell.offset] : (void *)&cell.int8;
+		}
+	};
+
+	struct Config
+	{
+		std::string url;
+		std::string user;
+		std::string password;
+		std::shared_ptr<TCIEnvironment> environment; // optional shared environment
+	};
+
+public:
+	TCI(const Napi::CallbackInfo &info) : Napi::ObjectWrap<TCI>(info), env(info.Env())
+	{
+	}
+
+	~TCI()
+	{
+		free();
+	}
+
+	static void Init(Napi::Env env, Napi::Object exports)
+	{
+		// define the js class wrapper
+		auto tci = DefineClass(env, "TCI", {InstanceMethod<&TCI::connect>("connect"),										  //
+											InstanceMethod<&TCI::connectAsync>("connectAsync"),								  //
+											InstanceMethod<&TCI::borrowAsync>("borrowAsync"),								  //
+											InstanceMethod<&TCI::executeDirectAsync>("executeDirectAsync"),					  //
+											InstanceMethod<&TCI::cancel>("cancel"),											  //
+											InstanceMethod<&TCI::resetCancellation>("resetCancellation"),					  //
+											InstanceMethod<&TCI::prepareAsync>("prepareAsync"),								  //
+											InstanceMethod<&TCI::executeAsync>("executeAsync"),								  //
+											InstanceMethod<&TCI::fetchAsync>("fetchAsync"),									  //
+											InstanceMethod<&TCI::executeDirect>("executeDirect"),							  //
+											InstanceMethod<&TCI::prepare>("prepare"),										  //
+											InstanceMethod<&TCI::execute>("execute"),										  //
+											InstanceMethod<&TCI::setParam>("setParam"),										  //
+											InstanceMethod<&TCI::setParams>("setParams"),									  //
+											InstanceMethod<&TCI::executeBatch>("executeBatch"),								  //
+											InstanceMethod<&TCI::executeBatchAsync>("executeBatchAsync"),					  //
+											InstanceMethod<&TCI::executeScript>("executeScript"),							  //
+											InstanceMethod<&TCI::executeScriptAsync>("executeScriptAsync"),					  //
+											InstanceMethod<&TCI::fetch>("fetch"),											  //
+											InstanceMethod<&TCI::fetchRows>("fetchRows"),									  //
+											InstanceMethod<&TCI::fetchColumns>("fetchColumns"),								  //
+											InstanceMethod<&TCI::fetchRowsAsync>("fetchRowsAsync"),							  //
+											InstanceMethod<&TCI::fetchColumnsAsync>("fetchColumnsAsync"),					  //
+											InstanceMethod<&TCI::fetchLazy>("fetchLazy"),									  //
+											InstanceMethod<&TCI::fetchLazyAsync>("fetchLazyAsync"),							  //
+											InstanceMethod<&TCI::hashLedgerRecord>("hashLedgerRecord"),						  //
+											InstanceMethod<&TCI::hashLedgerRecords>("hashLedgerRecords"),					  //
+											InstanceMethod<&TCI::hashLedgerRecordsAsync>("hashLedgerRecordsAsync"),			  //
+											InstanceMethod<&TCI::getLazyValue>("getLazyValue"),								  //
+											InstanceMethod<&TCI::exportAsync>("exportAsync"),								  //
+											InstanceMethod<&TCI::importAsync>("importAsync"),								  //
+											InstanceMethod<&TCI::getState>("getState"),										  //
+											InstanceMethod<&TCI::getResultSetAttribute>("getResultSetAttribute"),			  //
+											InstanceMethod<&TCI::getResultSetStringAttribute>("getResultSetStringAttribute"), //
+											InstanceMethod<&TCI::getValue>("getValue"),										  //
+											InstanceMethod<&TCI::getValueAsBuffer>("getValueAsBuffer"),						  //
+											InstanceMethod<&TCI::getValueInto>("getValueInto"),								  //
+											InstanceMethod<&TCI::getValueIntoAsync>("getValueIntoAsync"),					  //
+											InstanceMethod<&TCI::appendParam>("appendParam"),								  //
+											InstanceMethod<&TCI::getQueryType>("getQueryType"),								  //
+											InstanceMethod<&TCI::close>("close"),											  //
+											InstanceMethod<&TCI::openCursor>("openCursor"),									  //
+											InstanceMethod<&TCI::closeCursor>("closeCursor"),								  //
+											InstanceMethod<&TCI::useCursor>("useCursor"),									  //
+											InstanceMethod<&TCI::setTypeCast>("setTypeCast"),								  //
+											InstanceMethod<&TCI::describe>("describe"),										  //
+											InstanceMethod<&TCI::setInternStrings>("setInternStrings"),						  //
+											InstanceMethod<&TCI::setDateCast>("setDateCast"),								  //
+											InstanceMethod<&TCI::setStatementCacheSize>("setStatementCacheSize"),			  //
+											InstanceMethod<&TCI::getStatementCacheStats>("getStatementCacheStats"),			  //
+											InstanceMethod<&TCI::setResultCache>("setResultCache"),							  //
+											InstanceMethod<&TCI::getResultCacheStats>("getResultCacheStats"),				  //
+											InstanceMethod<&TCI::invalidateResultCache>("invalidateResultCache"),			  //
+											InstanceMethod<&TCI::getCachedResult>("getCachedResult"),						  //
+											InstanceMethod<&TCI::cacheResult>("cacheResult"),								  //
+											InstanceMethod<&TCI::cacheResultAsync>("cacheResultAsync"),						  //
+											InstanceMethod<&TCI::getCachedRows>("getCachedRows"),							  //
+											InstanceMethod<&TCI::setStatsEnabled>("setStatsEnabled"),						  //
+											InstanceMethod<&TCI::getStats>("getStats"),										  //
+											InstanceMethod<&TCI::resetStats>("resetStats"),									  //
+											InstanceMethod<&TCI::beginTransaction>("beginTransaction"),						  //
+											InstanceMethod<&TCI::commit>("commit"),											  //
+											InstanceMethod<&TCI::rollback>("rollback"),										  //
+											InstanceMethod<&TCI::getIsNull>("getIsNull"),									  //
+											InstanceMethod<&TCI::getVersionInfo>("getVersionInfo")});
+		exports.Set("TCI", tci);
+	}
+
+	void connect(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		open(getConfig(info));
+	}
+
+	Napi::Value connectAsync(const Napi::CallbackInfo &info)
+	{
+		auto config = getConfig(info);
+		return async([this, config]()
+					 { open(config); });
+	}
+
+	Config getConfig(const Napi::CallbackInfo &info)
+	{
+		if (info.Length() < 1 || !info[0].IsObject())
+			throw Napi::Error::New(env, "connect is missing config argument {url,user,password}");
+
+		Napi::Object config = info[0].As<Napi::Object>();
+
+		if (!(config.HasOwnProperty("url") && config.Get("url").IsString()))
+			throw Napi::Error::New(env, "connect requires a string url");
+		if (!(config.HasOwnProperty("user") && config.Get("user").IsString()))
+			throw Napi::Error::New(env, "connect requires a string user");
+		if (!(config.HasOwnProperty("password") && config.Get("password").IsString()))
+			throw Napi::Error::New(env, "connect requires a string password");
+
+		std::shared_ptr<TCIEnvironment> environment;
+		if (info.Length() > 1 && info[1].IsObject())
+		{
+			auto shared = Addon::unwrap<Environment>(info[1], &Addon::environment);
+			if (!shared)
+				throw Napi::TypeError::New(env, "connect requires an Environment of this thread");
+			environment = shared->environment;
+		}
+
+		return {
+			config.Get("url").As<Napi::String>(),
+			config.Get("user").As<Napi::String>(),
+			config.Get("password").As<Napi::String>(),
+			environment,
+		};
+	}
+
+	void open(Config config)
+	{
+		if (config.environment)
+			environment = config.environment;
+		else if ((state = Environment::alloc(environment, errorMessage, sizeof(errorMessage))))
+			fail();
+
+		if ((state = TCIAllocError(environment.get(), &error)))
+		{
+			TCIGetEnvironmentError(environment.get(), 1, errorMessage, sizeof(errorMessage), NULL, NULL);
+			free();
+			fail();
+		}
+
+		tci(TCIAllocConnection(environment.get(), error, &connection));
+		tci(TCIAllocTransaction(environment.get(), error, &transaction));
+		tci(TCIConnect(connection, &config.url[0]));
+		tci(TCILogin(connection, &config.user[0], &config.password[0]));
+		tci(TCIAllocStatement(connection, error, &directStatement));
+		tci(TCIAllocResultSet(directStatement, error, &directResultSet));
+		statement = directStatement;
+		resultSet = directResultSet;
+	}
+
+	void setTypeCast(const Napi::CallbackInfo &info)
+	{
+		typeCast = info[0].As<Napi::Boolean>();
+	}
+
+	void setInternStrings(const Napi::CallbackInfo &info)
+	{
+		internStrings = info[0].ToBoolean().Value();
+	}
+
+	void setDateCast(const Napi::CallbackInfo &info)
+	{
+		auto value = info[0].ToString().Utf8Value();
+		if (value == "string")
+			dateCast = Temporal::STRING;
+		else if (value == "date")
+			dateCast = Temporal::DATE;
+		else if (value == "epoch")
+			dateCast = Temporal::EPOCH;
+		else
+			throw Napi::TypeError::New(env, "dateCast must be one of \"string\", \"date\" or \"epoch\"");
+		results.clear(); // the cached temporal values were converted with the previous setting
+	}
+
+	/**
+	 * execute a query directly
+	 * @param query the sql text
+	 * @param timeout optional milliseconds after which the execution and the reading of its result set are cancelled
+	 */
+	void executeDirect(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		std::string query = info[0].As<Napi::String>().Utf8Value();
+		executeDirect(query, getTimeout(info, 1));
+	}
+
+	Napi::Value executeDirectAsync(const Napi::CallbackInfo &info)
+	{
+		std::string query = info[0].As<Napi::String>().Utf8Value();
+		auto timeout = getTimeout(info, 1);
+		return async([this, query, timeout]() mutable
+					 { executeDirect(query, timeout); });
+	}
+
+	void executeDirect(std::string &query, uint32_t timeout = 0)
+	{
+		beginExecution(timeout);
+		runDirect(query);
+	}
+
+	/** execute a query directly as part of the current execution, e.g. a statement of a script */
+	void runDirect(std::string &query)
+	{
+		if (cursor)
+			cursor->reset();
+		else
+		{
+			useDirect();
+			directDescription.reset();
+		}
+		if (cancellation.reason.load(std::memory_order_relaxed))
+			cancelled();
+		{
+			Stats::Timer timer(stats, stats.execute);
+			Cancellable call(cancellation, resultSet);
+			tci(TCIExecuteDirect(resultSet, &query[0], 1, 0));
+		}
+		stats.beginQuery();
+	}
+
+	/** timeout argument at index in milliseconds, 0 (none) if it is missing */
+	uint32_t getTimeout(const Napi::CallbackInfo &info, size_t index)
+	{
+		return info.Length() > index && info[index].IsNumber() ? info[index].As<Napi::Number>().Uint32Value() : 0;
+	}
+
+	/**
+	 * begin the next execution, it and its result set expire after timeout milliseconds unless 0.
+	 * It fails right away on an abort since js reset the cancellation for it, e.g. while it was queued.
+	 */
+	void beginExecution(uint32_t timeout)
+	{
+		cancellation.limit.timeout = timeout;
+		if (timeout)
+			cancellation.limit.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+		if (!cancellation.reset)
+			cancellation.reason = Cancellation::NONE;
+		cancellation.reset = false;
+		if (cancellation.reason.load())
+			cancelled();
+	}
+
+	/** forget the cancellation of the previous execution before js sets up the next one, @see beginExecution */
+	void resetCancellation(const Napi::CallbackInfo &info)
+	{
+		if (busy)
+			return; // the running call keeps its cancellation, the next one fails as the connection is busy
+		cancellation.reason = Cancellation::NONE;
+		cancellation.reset = true;
+	}
+
+	/**
+	 * cancel the running call, e.g. when an AbortSignal fired. It fails with an AbortError like all further calls of the
+	 * current execution. Unlike all other methods it may be called while the connection is busy.
+	 */
+	void cancel(const Napi::CallbackInfo &info)
+	{
+		cancellation.cancel(Cancellation::ABORT);
+	}
+
+	/** close the result set of a cancelled execution and raise a TimeoutError or AbortError */
+	void cancelled()
+	{
+		TCIClose(resultSet);
+		state = TCI_ERROR;
+		auto reason = (Cancellation::Reason)cancellation.reason.load();
+		auto message = reason == Cancellation::TIMEOUT ? "query timeout after " + std::to_string(cancellation.limit.timeout) + "ms" : std::string("query aborted");
+		if (offThread)
+			throw Cancelled(reason, message);
+		throw cancelError(reason, message);
+	}
+
+	/** a TimeoutError or AbortError, of the error classes set by js if there are any */
+	Napi::Error cancelError(Cancellation::Reason reason, const std::string &message)
+	{
+		auto timeout = reason == Cancellation::TIMEOUT;
+		Napi::Value error;
+#if NAPI_VERSION > 5
+		auto addon = env.GetInstanceData<Addon>();
+		auto &constructor = timeout ? addon->timeoutError : addon->abortError;
+		if (!constructor.IsEmpty())
+			error = constructor.New({Napi::String::New(env, message), Napi::Number::New(env, cancellation.limit.timeout)});
+#endif
+		if (error.IsEmpty())
+		{
+			auto object = Napi::Error::New(env, message).Value();
+			object.Set("name", timeout ? "TimeoutError" : "AbortError");
+			object.Set("code", timeout ? "ETIMEDOUT" : "ABORT_ERR");
+			if (timeout)
+				object.Set("timeout", cancellation.limit.timeout);
+			error = object;
+		}
+		return Napi::Error(env, error);
+	}
+
+	void prepare(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		auto query = info[0].As<Napi::String>().Utf8Value();
+		prepare(query);
+	}
+
+	Napi::Value prepareAsync(const Napi::CallbackInfo &info)
+	{
+		auto query = info[0].As<Napi::String>().Utf8Value();
+		return async([this, query]() mutable
+					 { prepare(query); });
+	}
+
+	/** make the statement the current one, prepared statements are reused from the statement cache */
+	void prepare(std::string &query)
+	{
+		Stats::Timer timer(stats, stats.prepare);
+		lobs.clear(); // drop incomplete uploads of a previous statement
+		if (cursor)
+		{
+			// a cursor keeps its last prepared query instead of using the statement cache
+			if (cursor->sql == query)
+			{
+				TCIClose(resultSet);
+				return;
+			}
+			TCIClose(resultSet);
+			cursor->reset();
+			tci(TCIPrepare(statement, &query[0]));
+			cursor->sql = query;
+			return;
+		}
+		if (statements.capacity == 0)
+		{
+			useDirect();
+			directPlan = BindPlan();
+			directDescription.reset();
+			tci(TCIPrepare(statement, &query[0]));
+			return;
+		}
+
+		auto entry = statements.get(query);
+		if (entry)
+		{
+			TCIClose(entry->resultSet); // close the cursor of a previous execution, if still open
+		}
+		else
+		{
+			while (statements.isFull())
+				freeStatement(statements.evict());
+
+			StatementCache::Entry created{query};
+			try
+			{
+				tci(TCIAllocStatement(connection, error, &created.statement));
+				tci(TCIAllocResultSet(created.statement, error, &created.resultSet));
+				tci(TCIPrepare(created.statement, &query[0]));
+			}
+			catch (...)
+			{
+				freeStatement(created);
+				throw;
+			}
+			entry = statements.put(created);
+		}
+		statement = entry->statement;
+		resultSet = entry->resultSet;
+		plan = &entry->plan;
+		description = &entry->description;
+	}
+
+	Cursor *unwrapCursor(Napi::Value value)
+	{
+		auto unwrapped = Addon::unwrap<Cursor>(value, &Addon::cursor);
+		if (!unwrapped)
+			throw Napi::TypeError::New(env, "a Cursor of this thread is required");
+		return unwrapped;
+	}
+
+	/** allocate or reuse the handles of a new Cursor */
+	void openCursor(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		auto opened = unwrapCursor(info[0]);
+		auto handles = handlePool->acquire();
+		if (!handles)
+		{
+			handles = std::make_shared<Handles>();
+			try
+			{
+				tci(TCIAllocStatement(connection, error, &handles->statement));
+				tci(TCIAllocResultSet(handles->statement, error, &handles->resultSet));
+			}
+			catch (...)
+			{
+				handles->free();
+				throw;
+			}
+			handlePool->add(handles);
+		}
+		opened->release();
+		opened->pool = handlePool;
+		opened->handles = handles;
+	}
+
+	/** give the handles of a cursor back to the connection, its result set is closed */
+	void closeCursor(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		auto closed = unwrapCursor(info[0]);
+		if (cursor && cursor == closed->handles)
+			restoreHandles();
+		closed->release();
+	}
+
+	/**
+	 * run the following calls on the handles of the given cursor, or on the connection's own handles again if it is undefined.
+	 * the connection's own handles are restored when an async operation completes.
+	 */
+	void useCursor(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		if (info.Length() == 0 || info[0].IsUndefined())
+		{
+			restoreHandles();
+			return;
+		}
+		auto selected = unwrapCursor(info[0])->handles;
+		if (!selected || !selected->statement)
+			throw Napi::Error::New(env, "cursor is closed");
+		if (selected == cursor)
+			return;
+		restoreHandles();
+		saved = {statement, resultSet, plan, description, state, cancellation.limit, cancellation.reason};
+		cursor = selected;
+		statement = cursor->statement;
+		resultSet = cursor->resultSet;
+		plan = &cursor->plan;
+		description = &cursor->description;
+		state = cursor->state;
+		cancellation.limit = cursor->limit;
+		cancellation.reason = cursor->cancelled;
+	}
+
+	/** select the connection's own handles again, and release the handles of cursors closed while busy */
+	void restoreHandles()
+	{
+		handlePool->drain();
+		if (!cursor)
+			return;
+		cursor->state = state;
+		cursor->limit = cancellation.limit;
+		cursor->cancelled = cancellation.reason;
+		statement = saved.statement;
+		resultSet = saved.resultSet;
+		plan = saved.plan;
+		description = saved.description;
+		state = saved.state;
+		cancellation.limit = saved.limit;
+		cancellation.reason = saved.cancelled;
+		auto deselected = cursor;
+		cursor.reset();
+		if (deselected->released)
+			handlePool->release(deselected);
+	}
+
+	void useDirect()
+	{
+		statement = directStatement;
+		resultSet = directResultSet;
+		plan = &directPlan;
+		description = &directDescription;
+	}
+
+	void freeStatement(const StatementCache::Entry &entry)
+	{
+		if (entry.resultSet)
+		{
+			TCIClose(entry.resultSet);
+			TCIFreeResultSet(entry.resultSet);
+		}
+		if (entry.statement)
+			TCIFreeStatement(entry.statement);
+		if (statement == entry.statement)
+			useDirect();
+	}
+
+	void setStatementCacheSize(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		statements.capacity = info[0].As<Napi::Number>().Uint32Value();
+		while (statements.entries.size() > statements.capacity)
+			freeStatement(statements.evict());
+	}
+
+	Napi::Value getStatementCacheStats(const Napi::CallbackInfo &info)
+	{
+		auto stats = Napi::Object::New(env);
+		stats.Set("size", statements.entries.size());
+		stats.Set("capacity", statements.capacity);
+		stats.Set("hits", statements.hits);
+		stats.Set("misses", statements.misses);
+		stats.Set("evictions", statements.evictions);
+		return stats;
+	}
+
+	/** configure the result cache {maxBytes, ttl, maxRows}, cached results are dropped */
+	void setResultCache(const Napi::CallbackInfo &info)
+	{
+		auto options = info[0].IsObject() ? info[0].As<Napi::Object>() : Napi::Object::New(env);
+		if (options.Has("maxBytes"))
+			results.maxBytes = (size_t)options.Get("maxBytes").As<Napi::Number>().Int64Value();
+		if (options.Has("ttl"))
+			results.ttl = options.Get("ttl").As<Napi::Number>().DoubleValue();
+		if (options.Has("maxRows"))
+			results.maxRows = std::min(options.Get("maxRows").As<Napi::Number>().Uint32Value(), UINT32_MAX - 1);
+		results.clear();
+	}
+
+	Napi::Value getResultCacheStats(const Napi::CallbackInfo &info)
+	{
+		auto stats = Napi::Object::New(env);
+		stats.Set("size", results.entries.size());
+		stats.Set("bytes", (double)results.bytes);
+		stats.Set("maxBytes", (double)results.maxBytes);
+		stats.Set("hits", results.hits);
+		stats.Set("misses", results.misses);
+		stats.Set("evictions", results.evictions);
+		stats.Set("expirations", results.expirations);
+		stats.Set("invalidations", results.invalidations);
+		return stats;
+	}
+
+	/** drop the cached results referencing one of the given tables, all of them without tables */
+	void invalidateResultCache(const Napi::CallbackInfo &info)
+	{
+		std::vector<std::string> tables;
+		if (info.Length() > 0 && info[0].IsArray())
+		{
+			auto array = info[0].As<Napi::Array>();
+			for (uint32_t i = 0; i < array.Length(); i++)
+				tables.push_back(array.Get(i).ToString().Utf8Value());
+		}
+		results.invalidate(tables);
+	}
+
+	/** the cached result of a key as {entry, columns, length, complete}, undefined if it is not cached or expired */
+	Napi::Value getCachedResult(const Napi::CallbackInfo &info)
+	{
+		auto entry = results.get(info[0].ToString().Utf8Value());
+		if (!entry)
+			return env.Undefined();
+		return toCachedResult(entry, true);
+	}
+
+	/**
+	 * fetch the rows of the current result set into a result cache entry, it is cached if they are all fetched.
+	 * At most maxRows + 1 rows are fetched, the rows after them are left to be fetched from the result set.
+	 * @param key sql text, typeCast and parameters of the query
+	 * @param tables tables referenced by the query, the entry is invalidated by writes to one of them
+	 * @param typeCast optional typeCast override, the connection setting is used otherwise
+	 * @returns {entry, columns, length, complete}
+	 */
+	Napi::Value cacheResult(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		auto entry = newCacheEntry(info);
+		fetchCacheEntry(*entry);
+		return storeCacheEntry(entry);
+	}
+
+	/** same as cacheResult, but the rows are fetched on a worker thread */
+	Napi::Value cacheResultAsync(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		auto entry = newCacheEntry(info);
+		return async([this, entry]()
+					 { fetchCacheEntry(*entry); },
+					 [this, entry]()
+					 { return storeCacheEntry(entry); });
+	}
+
+	std::shared_ptr<ResultCache::Entry> newCacheEntry(const Napi::CallbackInfo &info)
+	{
+		auto entry = std::make_shared<ResultCache::Entry>();
+		entry->key = info[0].ToString().Utf8Value();
+		auto tables = info[1].As<Napi::Array>();
+		for (uint32_t i = 0; i < tables.Length(); i++)
+			entry->tables.push_back(tables.Get(i).ToString().Utf8Value());
+		entry->columns = std::move(*getColumnBuffers(getTypeCast(info, 2)));
+		entry->description = *description;
+		return entry;
+	}
+
+	void fetchCacheEntry(ResultCache::Entry &entry)
+	{
+		entry.length = fetchColumnBuffers(entry.columns, results.maxRows + 1);
+		for (auto &column : entry.columns)
+			entry.bytes += column.size();
+	}
+
+	Napi::Value storeCacheEntry(std::shared_ptr<ResultCache::Entry> entry)
+	{
+		auto complete = entry->length <= results.maxRows;
+		if (complete)
+			results.put(entry);
+		return toCachedResult(entry, complete);
+	}
+
+	/** a cache entry for js, the entry is kept alive by the js value while its rows are read, even if it is evicted */
+	Napi::Value toCachedResult(std::shared_ptr<ResultCache::Entry> entry, bool complete)
+	{
+		auto finalize = [](Napi::Env env, std::shared_ptr<ResultCache::Entry> *entry)
+		{
+			delete entry;
+		};
+		auto columns = Napi::Array::New(env, entry->description->columns.size());
+		for (uint32_t i = 0; i < columns.Length(); i++)
+		{
+			auto &column = entry->description->columns[i];
+			columns.Set(i, toJsColumn(column, Napi::String::New(env, column.name)));
+		}
+		auto result = Napi::Object::New(env);
+		result.Set("entry", Napi::External<std::shared_ptr<ResultCache::Entry>>::New(env, new std::shared_ptr<ResultCache::Entry>(entry), finalize));
+		result.Set("columns", columns);
+		result.Set("length", entry->length);
+		result.Set("complete", complete);
+		return result;
+	}
+
+	/** row objects of up to maxRows cached rows from offset on, does not access the result set */
+	Napi::Value getCachedRows(const Napi::CallbackInfo &info)
+	{
+		auto &entry = **info[0].As<Napi::External<std::shared_ptr<ResultCache::Entry>>>().Data();
+		auto offset = std::min(info[1].As<Napi::Number>().Uint32Value(), entry.length);
+		auto count = std::min(info[2].As<Napi::Number>().Uint32Value(), entry.length - offset);
+		std::vector<Napi::String> keys;
+		for (auto &column : entry.columns)
+			keys.push_back(Napi::String::New(env, column.name));
+		return toRows(entry.columns, keys, offset, count);
+	}
+
+	/**
+	 * execute the current (prepared) statement
+	 * @param timeout optional milliseconds after which the execution and the reading of its result set are cancelled
+	 */
+	void execute(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		executeStatement(getTimeout(info, 0));
+	}
+
+	Napi::Value executeAsync(const Napi::CallbackInfo &info)
+	{
+		auto timeout = getTimeout(info, 0);
+		return async([this, timeout]()
+					 { executeStatement(timeout); });
+	}
+
+	/** execute the current (prepared) statement */
+	void executeStatement(uint32_t timeout = 0)
+	{
+		beginExecution(timeout);
+		runStatement();
+	}
+
+	/** execute the current statement as part of the current execution, e.g. a row of a batch */
+	void runStatement()
+	{
+		if (cancellation.reason.load(std::memory_order_relaxed))
+			cancelled();
+		{
+			Stats::Timer timer(stats, stats.execute);
+			Cancellable call(cancellation, resultSet);
+			tci(TCIExecute(resultSet, 1, 0));
+		}
+		stats.beginQuery();
+	}
+
+	void setParam(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		auto value = BindValue::from(info[1]);
+		if (info[0].IsNumber())
+			bind(info[0].As<Napi::Number>().Uint32Value() + 1, "", value);
+		else
+			bind(0, info[0].As<Napi::String>().Utf8Value(), value);
+	}
+
+	/**
+	 * convert and bind all parameters, an array of positional or an object of named parameters, in one call.
+	 * The converted values are kept in the bind plan of the statement, named parameters are looked up by
+	 * the names of the plan, which is compiled again if the parameters have other names.
+	 */
+	void setParams(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		auto &plan = *this->plan;
+		if (info[0].IsArray())
+		{
+			auto parameters = info[0].As<Napi::Array>();
+			if (plan.named || plan.values.size() != parameters.Length())
+				plan.compile(parameters.Length());
+			for (uint32_t i = 0; i < plan.values.size(); i++)
+			{
+				plan.values[i].reassign(parameters.Get(i));
+				bind(i + 1, "", plan.values[i]);
+			}
+		}
+		else if (info[0].IsObject())
+		{
+			auto parameters = info[0].As<Napi::Object>();
+			// as many names, all of them found by bindNamed, are the same names
+			if (!plan.named || plan.names.size() != parameters.GetPropertyNames().Length() || !bindNamed(plan, parameters))
+			{
+				plan.compile(parameters);
+				bindNamed(plan, parameters);
+			}
+		}
+		else
+		{
+			throw Napi::TypeError::New(env, "setParams requires an array of positional or an object of named parameters");
+		}
+	}
+
+	/** bind the named parameters of the plan, false if one of them is missing in parameters */
+	bool bindNamed(BindPlan &plan, Napi::Object &parameters)
+	{
+		for (size_t i = 0; i < plan.names.size(); i++)
+		{
+			auto value = parameters.Get(plan.names[i]);
+			if (value.IsUndefined() && !parameters.Has(plan.names[i]))
+				return false;
+			plan.values[i].reassign(value);
+			bind(0, plan.names[i], plan.values[i]);
+		}
+		return true;
+	}
+
+	void beginTransaction(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		tci(TCIBeginTransaction(transaction, connection));
+	}
+
+	void commit(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		tci(TCICommitTransaction(transaction));
+	}
+
+	void rollback(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		tci(TCIRollbackTransaction(transaction));
+	}
+
+	/**
+	 * append a chunk (Buffer or string) to a large parameter, e.g. of a blob or clob column,
+	 * the parameter is bound at once with the last chunk
+	 */
+	void appendParam(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		auto key = info[0].ToString().Utf8Value();
+		auto &lob = lobs[key];
+		if (info[1].IsBuffer())
+		{
+			auto chunk = info[1].As<Napi::Buffer<char>>();
+			lob.type = TCI_C_BYTE;
+			lob.bytes.append(chunk.Data(), chunk.Length());
+			stats.count(stats.lobBytes, chunk.Length());
+		}
+		else if (!info[1].IsNull() && !info[1].IsUndefined())
+		{
+			auto chunk = info[1].ToString().Utf8Value();
+			lob.bytes.append(chunk);
+			stats.count(stats.lobBytes, chunk.size());
+		}
+
+		if (info.Length() > 2 && info[2].ToBoolean().Value())
+		{
+			if (info[0].IsNumber())
+				bind(info[0].As<Napi::Number>().Uint32Value() + 1, "", lob);
+			else
+				bind(0, key, lob);
+			lobs.erase(key);
+		}
+	}
+
+	/** bind a converted value to a positional (starting with 1) or, if name is not empty, a named parameter */
+	void bind(TCIColumnnumber position, const std::string &name, BindValue &value)
+	{
+		bind(position, name, value.data(), value.size(), value.type, &value.isNull);
+	}
+
+	void bind(TCIColumnnumber position, const std::string &name, void *data, Int4 size, Int2 type, Int2 *isNull)
+	{
+		if (name.empty())
+			tci(TCISetData(resultSet, position, data, size, type, isNull));
+		else
+			tci(TCISetDataByName(resultSet, (Char *)name.c_str(), data, size, type, isNull));
+	}
+
+	/**
+	 * execute a statement once per row of parameters
+	 * @param sql the statement to prepare once
+	 * @param rows array of positional parameter arrays or of named parameter objects
+	 * @param options optional {chunkSize, transactional}
+	 */
+	Napi::Value executeBatch(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		auto batch = getBatch(info);
+		runBatch(*batch);
+		return getBatchResult(*batch);
+	}
+
+	Napi::Value executeBatchAsync(const Napi::CallbackInfo &info)
+	{
+		auto batch = getBatch(info);
+		return async([this, batch]()
+					 { runBatch(*batch); },
+					 [this, batch]()
+					 { return getBatchResult(*batch); });
+	}
+
+	std::shared_ptr<Batch> getBatch(const Napi::CallbackInfo &info)
+	{
+		if (info.Length() < 2 || !info[0].IsString() || !info[1].IsArray())
+			throw Napi::TypeError::New(env, "executeBatch requires a sql string and an array of parameter rows");
+
+		auto batch = std::make_shared<Batch>();
+		batch->sql = info[0].As<Napi::String>().Utf8Value();
+		if (info.Length() > 2 && info[2].IsObject())
+		{
+			auto options = info[2].As<Napi::Object>();
+			if (options.Get("chunkSize").IsNumber())
+				batch->chunkSize = std::max(1u, options.Get("chunkSize").As<Napi::Number>().Uint32Value());
+			if (options.Has("transactional"))
+				batch->transactional = options.Get("transactional").ToBoolean();
+			if (options.Get("timeout").IsNumber())
+				batch->timeout = options.Get("timeout").As<Napi::Number>().Uint32Value();
+		}
+
+		// the plan is inferred from the first row, the values of the other rows mostly convert to the types of the previous row
+		auto rows = info[1].As<Napi::Array>();
+		auto &plan = batch->plan;
+		for (uint32_t i = 0; i < rows.Length(); i++)
+		{
+			auto row = rows.Get(i);
+			if (row.IsArray())
+			{
+				auto array = row.As<Napi::Array>();
+				if (i == 0)
+					plan.compile(array.Length());
+				else if (plan.named)
+					throw Napi::TypeError::New(env, "executeBatch row " + std::to_string(i) + " is an array but the first row is an object of named parameters");
+				else if (array.Length() != plan.values.size())
+					throw Napi::TypeError::New(env, "executeBatch row " + std::to_string(i) + " has " + std::to_string(array.Length()) + " parameters but the first row has " + std::to_string(plan.values.size()));
+				for (uint32_t j = 0; j < array.Length(); j++)
+				{
+					plan.values[j].reassign(array.Get(j));
+					batch->add(plan.values[j]);
+				}
+			}
+			else if (row.IsObject())
+			{
+				auto object = row.As<Napi::Object>();
+				if (i == 0)
+					plan.compile(object);
+				else if (!plan.named)
+					throw Napi::TypeError::New(env, "executeBatch row " + std::to_string(i) + " is an object but the first row is an array of positional parameters");
+				else if (object.GetPropertyNames().Length() != plan.names.size())
+					throw Napi::TypeError::New(env, "executeBatch row " + std::to_string(i) + " has other parameter names than the first row");
+				for (size_t j = 0; j < plan.names.size(); j++)
+				{
+					if (!object.Has(plan.names[j]))
+						throw Napi::TypeError::New(env, "executeBatch row " + std::to_string(i) + " has no parameter " + plan.names[j]);
+					plan.values[j].reassign(object.Get(plan.names[j]));
+					batch->add(plan.values[j]);
+				}
+			}
+			else
+				throw Napi::TypeError::New(env, "executeBatch rows must either be arrays of positional parameters or objects of named parameters");
+			if (i == 0)
+				batch->cells.reserve((size_t)rows.Length() * plan.values.size());
+		}
+		batch->rowCount = rows.Length();
+		return batch;
+	}
+
+	/** execute all rows, committing every chunk if transactional. a failure is recorded in the batch */
+	void runBatch(Batch &batch)
+	{
+		size_t index = 0;
+		size_t chunkStart = 0;
+		bool inTransaction = false;
+		try
+		{
+			beginExecution(batch.timeout);
+			prepare(batch.sql);
+			const std::string positional;
+			auto width = batch.plan.values.size();
+			while (index < batch.rowCount)
+			{
+				chunkStart = index;
+				auto chunkEnd = std::min(index + batch.chunkSize, batch.rowCount);
+				if (batch.transactional)
+				{
+					tci(TCIBeginTransaction(transaction, connection));
+					inTransaction = true;
+				}
+				for (; index < chunkEnd; index++)
+				{
+					for (size_t j = 0; j < width; j++)
+					{
+						auto &cell = batch.cells[index * width + j];
+						bind(j + 1, batch.plan.named ? batch.plan.names[j] : positional, batch.data(cell), cell.size, cell.type, &cell.isNull);
+					}
+					runStatement();
+					batch.counts.push_back(getResultSetAttribute(TCI_ATTR_RECORDS_TOUCHED));
+				}
+				if (inTransaction)
+				{
+					index = chunkStart; // report the chunk if the commit fails
+					tci(TCICommitTransaction(transaction));
+					index = chunkEnd;
+					inTransaction = false;
+				}
+			}
+		}
+		catch (const std::exception &e)
+		{
+			batch.failedIndex = index;
+			batch.error = e.what();
+			batch.cancelled = cancellation.reason.load();
+			if (inTransaction)
+			{
+				TCIRollbackTransaction(transaction);
+				batch.counts.resize(chunkStart);
+			}
+		}
+	}
+
+	/** the affected record count of every row, or throw the first failure with its row index */
+	Napi::Value getBatchResult(Batch &batch)
+	{
+		auto counts = Napi::Array::New(env, batch.counts.size());
+		for (uint32_t i = 0; i < batch.counts.size(); i++)
+			counts.Set(i, batch.counts[i]);
+		if (batch.failedIndex >= 0)
+		{
+			auto error = batch.cancelled ? cancelError((Cancellation::Reason)batch.cancelled, batch.error) : Napi::Error::New(env, batch.error);
+			error.Value().Set("index", (double)batch.failedIndex);
+			error.Value().Set("rowCounts", counts);
+			throw error;
+		}
+		return counts;
+	}
+
+	/**
+	 * execute a list of statements, or a script split on its semicolons, in a single native call
+	 * @param script array of sql statements or a script text
+	 * @param options optional {transactional, stopOnError}
+	 */
+	Napi::Value executeScript(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		auto script = getScript(info);
+		runScript(*script);
+		return getScriptResult(*script);
+	}
+
+	Napi::Value executeScriptAsync(const Napi::CallbackInfo &info)
+	{
+		auto script = getScript(info);
+		return async([this, script]()
+					 { runScript(*script); },
+					 [this, script]()
+					 { return getScriptResult(*script); });
+	}
+
+	std::shared_ptr<Script> getScript(const Napi::CallbackInfo &info)
+	{
+		auto script = std::make_shared<Script>();
+		if (info[0].IsString())
+			script->statements = Script::split(info[0].As<Napi::String>().Utf8Value());
+		else if (info[0].IsArray())
+		{
+			auto statements = info[0].As<Napi::Array>();
+			for (uint32_t i = 0; i < statements.Length(); i++)
+				script->statements.push_back(statements.Get(i).ToString().Utf8Value());
+		}
+		else
+			throw Napi::TypeError::New(env, "executeScript requires a script string or an array of sql statements");
+		if (info.Length() > 1 && info[1].IsObject())
+		{
+			auto options = info[1].As<Napi::Object>();
+			if (options.Has("transactional"))
+				script->transactional = options.Get("transactional").ToBoolean();
+			if (options.Has("stopOnError"))
+				script->stopOnError = options.Get("stopOnError").ToBoolean();
+			if (options.Get("timeout").IsNumber())
+				script->timeout = options.Get("timeout").As<Napi::Number>().Uint32Value();
+		}
+		return script;
+	}
+
+	/**
+	 * execute the statements one after the other, inside one transaction if transactional.
+	 * the transaction is rolled back if a statement fails and stopOnError is set, committed otherwise.
+	 */
+	void runScript(Script &script)
+	{
+		bool inTransaction = false;
+		try
+		{
+			beginExecution(script.timeout);
+			if (script.transactional)
+			{
+				tci(TCIBeginTransaction(transaction, connection));
+				inTransaction = true;
+			}
+			for (auto &statement : script.statements)
+			{
+				Script::Result result;
+				auto start = std::chrono::steady_clock::now();
+				try
+				{
+					runDirect(statement);
+					result.queryType = getResultSetAttribute(TCI_ATTR_QUERY_TYPE);
+					if (sel_class(result.queryType))
+						TCIClose(resultSet); // the rows of a query are not read
+					else
+						result.records = getResultSetAttribute(TCI_ATTR_RECORDS_TOUCHED);
+				}
+				catch (const std::exception &e)
+				{
+					result.state = Script::FAILED;
+					result.error = e.what();
+				}
+				result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				script.results.push_back(std::move(result));
+				// a cancelled script stops regardless of stopOnError, all further statements would fail
+				script.cancelled = cancellation.reason.load();
+				if (script.results.back().state == Script::FAILED && (script.stopOnError || script.cancelled))
+				{
+					script.failedIndex = script.results.size() - 1;
+					script.error = script.results.back().error;
+					break;
+				}
+			}
+			if (inTransaction && script.error.empty())
+			{
+				inTransaction = false;
+				tci(TCICommitTransaction(transaction));
+			}
+		}
+		catch (const std::exception &e)
+		{
+			// begin or commit failed
+			script.failedIndex = script.results.size();
+			script.error = e.what();
+			script.cancelled = cancellation.reason.load();
+		}
+		if (inTransaction)
+		{
+			TCIRollbackTransaction(transaction);
+			for (auto &result : script.results)
+			{
+				if (result.state == Script::OK)
+					result.state = Script::ROLLED_BACK;
+			}
+		}
+	}
+
+	/** {state, type, records, ms, error} of every executed statement, or throw the failure aborting the script */
+	Napi::Value getScriptResult(Script &script)
+	{
+		static const char *STATES[] = {"ok", "failed", "rolledBack"};
+		auto results = Napi::Array::New(env, script.results.size());
+		for (uint32_t i = 0; i < script.results.size(); i++)
+		{
+			auto &result = script.results[i];
+			auto object = Napi::Object::New(env);
+			object.Set("state", STATES[result.state]);
+			if (result.state != Script::FAILED)
+				object.Set("type", toQueryType(result.queryType));
+			object.Set("records", result.records);
+			object.Set("ms", result.ms);
+			if (!result.error.empty())
+				object.Set("error", result.error);
+			results.Set(i, object);
+		}
+		if (!script.error.empty())
+		{
+			auto error = script.cancelled ? cancelError((Cancellation::Reason)script.cancelled, script.error) : Napi::Error::New(env, script.error);
+			error.Value().Set("index", (double)script.failedIndex);
+			error.Value().Set("results", results);
+			throw error;
+		}
+		return results;
+	}
+
+	/**
+	 * insert the records of a csv or ndjson file into a table on a worker thread, @see Import
+	 * @param table the target table
+	 * @param path the file to read
+	 * @param options {format, columns, header, delimiter, batchSize, transactional, maxRejects, onProgress}
+	 * @returns a promise of {rows, rejected, rejects, bytes}
+	 */
+	Napi::Value importAsync(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString())
+			throw Napi::TypeError::New(env, "importFile requires a table name and a file path");
+
+		auto imported = std::make_shared<Import>();
+		imported->table = info[0].As<Napi::String>().Utf8Value();
+		if (!Import::isTableName(imported->table))
+			throw Napi::TypeError::New(env, "invalid table name " + imported->table + ", quote names that are no plain identifiers");
+		imported->path = info[1].As<Napi::String>().Utf8Value();
+		std::shared_ptr<Napi::ThreadSafeFunction> progress;
+		if (info.Length() > 2 && info[2].IsObject())
+		{
+			auto options = info[2].As<Napi::Object>();
+			auto format = options.Get("format");
+			if (!format.IsUndefined() && !Import::parseFormat(format.ToString().Utf8Value(), imported->format))
+				throw Napi::TypeError::New(env, "import format must be one of csv or ndjson");
+			if (options.Get("columns").IsArray())
+			{
+				auto columns = options.Get("columns").As<Napi::Array>();
+				for (uint32_t i = 0; i < columns.Length(); i++)
+					imported->columns.push_back(columns.Get(i).ToString().Utf8Value());
+			}
+			if (options.Has("header"))
+				imported->header = options.Get("header").ToBoolean().Value();
+			if (options.Get("delimiter").IsString())
+			{
+				auto delimiter = options.Get("delimiter").As<Napi::String>().Utf8Value();
+				if (delimiter.size() != 1)
+					throw Napi::TypeError::New(env, "import delimiter must be a single character");
+				imported->delimiter = delimiter[0];
+			}
+			if (options.Get("batchSize").IsNumber())
+				imported->batchSize = std::max(1u, options.Get("batchSize").As<Napi::Number>().Uint32Value());
+			if (options.Has("transactional"))
+				imported->transactional = options.Get("transactional").ToBoolean().Value();
+			if (options.Get("timeout").IsNumber())
+				imported->timeout = options.Get("timeout").As<Napi::Number>().Uint32Value();
+			if (options.Get("maxRejects").IsNumber())
+			{
+				auto maxRejects = options.Get("maxRejects").As<Napi::Number>().DoubleValue();
+				imported->maxRejects = maxRejects < (double)UINT64_MAX ? (uint64_t)std::max(0.0, maxRejects) : UINT64_MAX;
+			}
+			if (options.Get("onProgress").IsFunction())
+			{
+				progress = std::make_shared<Napi::ThreadSafeFunction>(Napi::ThreadSafeFunction::New(env, options.Get("onProgress").As<Napi::Function>(), "transbase import progress", 0, 1));
+				imported->onProgress = [progress](Import &imported)
+				{
+					auto counts = new std::vector<double>{(double)imported.rows, (double)imported.rejected, (double)imported.bytes};
+					progress->NonBlockingCall(counts, [](Napi::Env env, Napi::Function callback, std::vector<double> *counts)
+											  {
+												  if (env == nullptr)
+												  {
+													  delete counts; // the environment is shutting down
+													  return;
+												  }
+												  auto event = Napi::Object::New(env);
+												  event.Set("rows", (*counts)[0]);
+												  event.Set("rejected", (*counts)[1]);
+												  event.Set("bytes", (*counts)[2]);
+												  delete counts;
+												  callback.Call({event}); });
+				};
+			}
+		}
+		return async([this, imported, progress]()
+					 {
+						 runImport(*imported);
+						 if (progress)
+							 progress->Release(); },
+					 [this, imported]()
+					 { return getImportResult(*imported); });
+	}
+
+	void runImport(Import &imported)
+	{
+		bool inTransaction = false;
+		uint64_t pending = 0; // rows inserted by the current transaction
+		try
+		{
+			beginExecution(imported.timeout);
+			imported.open();
+			std::string sql = imported.describeSql();
+			runDirect(sql);
+			imported.describe(getColumns());
+			TCIClose(resultSet);
+			sql = imported.insertSql();
+			prepare(sql);
+
+			std::string rejected;
+			while (imported.read(rejected))
+			{
+				if (!rejected.empty())
+				{
+					imported.reject(rejected);
+					continue;
+				}
+				if (imported.transactional && !inTransaction)
+				{
+					tci(TCIBeginTransaction(transaction, connection));
+					inTransaction = true;
+				}
+				for (size_t i = 0; i < imported.values.size(); i++)
+					bind(i + 1, "", imported.values[i]);
+				try
+				{
+					runStatement();
+				}
+				catch (const std::exception &e)
+				{
+					// a field the database could not convert, e.g. a bad numeric or an overlong text
+					if (cancellation.reason.load() || !isDataException())
+						throw;
+					imported.reject(e.what());
+					continue;
+				}
+				if (++pending < imported.batchSize)
+					continue;
+				if (inTransaction)
+				{
+					tci(TCICommitTransaction(transaction));
+					inTransaction = false;
+				}
+				imported.rows += pending;
+				pending = 0;
+				if (imported.onProgress)
+					imported.onProgress(imported);
+			}
+			if (inTransaction)
+			{
+				tci(TCICommitTransaction(transaction));
+				inTransaction = false;
+			}
+			imported.rows += pending;
+			pending = 0;
+		}
+		catch (const std::exception &e)
+		{
+			imported.failed = true;
+			imported.error = e.what();
+			imported.cancelled = cancellation.reason.load();
+			if (inTransaction)
+				TCIRollbackTransaction(transaction);
+			else
+				imported.rows += pending; // auto-committed
+		}
+	}
+
+	/** the last error is a data exception (sqlstate class 22), e.g. of a value the database could not convert */
+	bool isDataException() const
+	{
+		return sqlcode[0] == '2' && sqlcode[1] == '2';
+	}
+
+	/** the counts of the import, or throw its failure with the line and the rows inserted before */
+	Napi::Value getImportResult(Import &imported)
+	{
+		auto result = Napi::Object::New(env);
+		result.Set("rows", (double)imported.rows);
+		result.Set("rejected", (double)imported.rejected);
+		auto rejects = Napi::Array::New(env, imported.rejects.size());
+		for (uint32_t i = 0; i < imported.rejects.size(); i++)
+		{
+			auto reject = Napi::Object::New(env);
+			reject.Set("line", (double)imported.rejects[i].first);
+			reject.Set("error", imported.rejects[i].second);
+			rejects.Set(i, reject);
+		}
+		result.Set("rejects", rejects);
+		result.Set("bytes", (double)imported.bytes);
+		if (imported.failed)
+		{
+			auto error = imported.cancelled ? cancelError((Cancellation::Reason)imported.cancelled, imported.error) : Napi::Error::New(env, imported.error);
+			error.Value().Set("line", (double)imported.line);
+			error.Value().Set("result", result);
+			throw error;
+		}
+		return result;
+	}
+
+	Napi::Value getQueryType(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		return toQueryType(getResultSetAttribute(TCI_ATTR_QUERY_TYPE));
+	}
+
+	/** "SELECT", "UPDATE" or "SCHEMA" for the classes of query types, the number of any other */
+	Napi::Value toQueryType(int queryType)
+	{
+		if (sel_class(queryType))
+			return Napi::String::New(env, "SELECT");
+		if (upd_class(queryType))
+			return Napi::String::New(env, "UPDATE");
+		if (ddl_class(queryType))
+			return Napi::String::New(env, "SCHEMA");
+		return Napi::Number::New(env, queryType);
+	}
+
+	Napi::Value getResultSetAttribute(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		auto attrKey = info[0].As<Napi::Number>().Uint32Value();
+		auto col = info.Length() > 1 ? info[1].As<Napi::Number>() : 1;
+		auto attr = getResultSetAttribute(attrKey, col);
+		return Napi::Number::New(env, attr);
+	}
+
+	int getResultSetAttribute(int attrKey, int col = 1)
+	{
+		Uint2 value = 0;
+		tci(TCIGetResultSetAttribute(resultSet, attrKey, col, &value, sizeof(value), NULL));
+		return value;
+	}
+
+	Napi::Value getVersionInfo(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		TCIVersion clientVersion;
+		tci(TCIGetEnvironmentAttribute(environment.get(), TCI_ATTR_VERSION, 1, &clientVersion, sizeof(clientVersion), NULL));
+		TCIVersion serverVersion;
+		tci(TCIGetConnectionAttribute(connection, TCI_ATTR_VERSION, 1, &serverVersion, sizeof(serverVersion), NULL));
+
+		auto version = Napi::Object::New(env);
+		version.Set("client", toVersion(clientVersion));
+		version.Set("server", toVersion(serverVersion));
+		return version;
+	}
+
+	Napi::Value toVersion(TCIVersion &version)
+	{
+		auto result = Napi::Object::New(env);
+		result.Set("major", version.major_version);
+		result.Set("minor", version.minor_version);
+		result.Set("release", version.release);
+		result.Set("patch", version.patch);
+		result.Set("build", version.build);
+		return result;
+	}
+
+	Napi::Value getResultSetStringAttribute(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		auto attrKey = info[0].As<Napi::Number>().Uint32Value();
+		auto col = info.Length() > 1 ? info[1].As<Napi::Number>() : 1;
+		return Napi::String::New(env, getResultSetStringAttribute(attrKey, col));
+	}
+
+	std::string getResultSetStringAttribute(int attrKey, int col = 1)
+	{
+		Char value[MAXIDENTSIZE];
+		tci(TCIGetResultSetAttribute(resultSet, attrKey, col, &value, sizeof(value), NULL));
+		return value;
+	}
+
+	/** column descriptors of the current result set, read once per execution or once per cached statement */
+	std::vector<Description::Column> &getColumns()
+	{
+		auto &current = *description;
+		if (!current)
+		{
+			auto described = std::make_shared<Description>();
+			auto colCount = getResultSetAttribute(TCI_ATTR_COLUMN_COUNT);
+			for (TCIColumnnumber col = 1; col <= colCount; col++)
+			{
+				Description::Column column;
+				column.col = col;
+				column.type = getResultSetAttribute(TCI_ATTR_COLUMN_TYPE, col);
+				column.name = getResultSetStringAttribute(TCI_ATTR_COLUMN_NAME, col);
+				column.typeName = Description::typeName(column.type);
+#ifdef TCI_ATTR_COLUMN_PRECISION
+				column.precision = getResultSetAttribute(TCI_ATTR_COLUMN_PRECISION, col);
+#endif
+#ifdef TCI_ATTR_COLUMN_SCALE
+				column.scale = getResultSetAttribute(TCI_ATTR_COLUMN_SCALE, col);
+#endif
+#ifdef TCI_ATTR_COLUMN_NULLABLE
+				column.nullable = getResultSetAttribute(TCI_ATTR_COLUMN_NULLABLE, col);
+#endif
+				described->columns.push_back(column);
+			}
+			current = described;
+		}
+		return current->columns;
+	}
+
+	/** js property keys of the current columns, created once per description */
+	std::vector<Napi::String> getColumnKeys()
+	{
+		describeJs();
+		std::vector<Napi::String> keys;
+		for (auto &key : columnKeys)
+			keys.push_back(key.Value());
+		return keys;
+	}
+
+	/** create the cached js values of the current description, unless they exist already */
+	void describeJs()
+	{
+		auto &columns = getColumns();
+		if (jsDescription == *description)
+			return;
+
+		columnKeys.clear();
+		auto infos = Napi::Array::New(env, columns.size());
+		for (uint32_t i = 0; i < columns.size(); i++)
+		{
+			auto key = Napi::String::New(env, columns[i].name);
+			columnKeys.push_back(Napi::Persistent(key));
+			infos.Set(i, toJsColumn(columns[i], key));
+		}
+		jsColumns = Napi::Persistent(infos.As<Napi::Object>());
+		jsDescription = *description;
+	}
+
+	Napi::Object toJsColumn(const Description::Column &column, Napi::String name)
+	{
+		auto info = Napi::Object::New(env);
+		info.Set("col", column.col);
+		info.Set("name", name);
+		info.Set("type", column.type);
+		info.Set("typeName", column.typeName);
+		if (column.precision >= 0)
+			info.Set("precision", column.precision);
+		if (column.scale >= 0)
+			info.Set("scale", column.scale);
+		if (column.nullable >= 0)
+			info.Set("nullable", column.nullable != 0);
+		return info;
 	}
 
-	void connect(const Napi::CallbackInfo &info)
+	/**
+	 * descriptors (col, name, type, typeName and precision, scale, nullable if reported) of all columns.
+	 * The same array is returned for every execution of a cached statement.
+	 */
+	Napi::Value describe(const Napi::CallbackInfo &info)
 	{
-		if (info.Length() != 1 || !info[0].IsObject())
-			throw Napi::Error::New(env, "connect is missing config argument {url,user,password}");
-
-		Napi::Object config = info[0].As<Napi::Object>();
+		ensureIdle();
+		describeJs();
+		return jsColumns.Value();
+	}
 
-		if (!(config.HasOwnProperty("url") && config.Get("url").IsString()))
-			throw Napi::Error::New(env, "connect requires a string url");
-		if (!(config.HasOwnProperty("user") && config.Get("user").IsString()))
-			throw Napi::Error::New(env, "connect requires a string user");
-		if (!(config.HasOwnProperty("password") && config.Get("password").IsString()))
-			throw Napi::Error::New(env, "connect requires a string password");
+	Napi::Value fetch(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		auto scrollMode = info.Length() > 0 ? info[0].As<Napi::Number>().Uint32Value() : TCI_FETCH_NEXT;
+		stats.flush(); // the cells read from the previous row
+		return Napi::Boolean::New(env, fetch(scrollMode));
+	}
 
-		std::string url = config.Get("url").As<Napi::String>();
-		std::string user = config.Get("user").As<Napi::String>();
-		std::string password = config.Get("password").As<Napi::String>();
+	Napi::Value fetchAsync(const Napi::CallbackInfo &info)
+	{
+		auto scrollMode = info.Length() > 0 ? info[0].As<Napi::Number>().Uint32Value() : TCI_FETCH_NEXT;
+		auto found = std::make_shared<bool>(false);
+		return async([this, scrollMode, found]()
+					 {
+						 stats.flush();
+						 *found = fetch(scrollMode); },
+					 [this, found]()
+					 { return Napi::Boolean::New(env, *found); });
+	}
 
-		if ((state = TCIAllocEnvironment(&environment) || (state = TCIAllocError(environment, &error))))
+	/** fetch the next row, returns false if no data is found */
+	bool fetch(Int2 scrollMode)
+	{
+		Cancellable call(cancellation, resultSet);
+		if (cancellation.reason.load(std::memory_order_relaxed))
+			cancelled();
+		auto start = stats.enabled ? Stats::now() : 0;
+		state = TCIFetch(resultSet, 1, scrollMode, 0);
+		if (start)
 		{
-			TCIGetEnvironmentError(environment, 1, errorMessage, sizeof(errorMessage), NULL, NULL);
-			free();
-			Napi::Error::New(env, errorMessage);
+			stats.recordFetch(Stats::now() - start, state == TCI_SUCCESS);
+			if (state == TCI_NO_DATA_FOUND)
+				stats.endQuery();
 		}
+		if (state == TCI_NO_DATA_FOUND)
+			return false;
+		tci(state);
+		return true;
+	}
+
+	/**
+	 * fetch up to maxRows rows and convert them to an array of row objects in one call
+	 * @param maxRows maximum number of rows to fetch
+	 * @param typeCast optional typeCast override, the connection setting is used otherwise
+	 */
+	Napi::Value fetchRows(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		auto maxRows = info[0].As<Napi::Number>().Uint32Value();
+		bool typeCast = getTypeCast(info, 1);
+		auto &columns = getColumns();
+		auto keys = getColumnKeys();
 
-		tci(TCIAllocConnection(environment, error, &connection));
-		tci(TCIAllocTransaction(environment, error, &transaction));
-		tci(TCIConnect(connection, &url[0]));
-		tci(TCILogin(connection, &user[0], &password[0]));
-		tci(TCIAllocStatement(connection, error, &statement));
-		tci(TCIAllocResultSet(statement, error, &resultSet));
+		std::vector<StringInterner> interners(internStrings ? columns.size() : 0);
+		auto rows = Napi::Array::New(env);
+		uint32_t count = 0;
+		uint64_t convertTime = 0;
+		Cancellable batch(cancellation, resultSet);
+		while (count < maxRows && fetch(TCI_FETCH_NEXT))
+		{
+			auto start = stats.enabled ? Stats::now() : 0;
+			auto row = Napi::Object::New(env);
+			for (size_t i = 0; i < columns.size(); i++)
+			{
+				this->isNull = 0;
+				auto value = getValue(columns[i].col, columns[i].type, typeCast, internStrings ? &interners[i] : nullptr);
+				row.Set(keys[i], isNull ? env.Null() : value);
+			}
+			rows.Set(count++, row);
+			if (start)
+				convertTime += Stats::now() - start;
+		}
+		stats.accumulate(stats.pendingConvert, convertTime);
+		stats.flush();
+		return rows;
 	}
 
-	void setTypeCast(const Napi::CallbackInfo &info)
+	/**
+	 * fetch up to maxRows rows in columnar layout, one typed array per column instead of a js value per cell
+	 * @param maxRows maximum number of rows to fetch
+	 * @param typeCast optional typeCast override, the connection setting is used otherwise
+	 */
+	Napi::Value fetchColumns(const Napi::CallbackInfo &info)
 	{
-		typeCast = info[0].As<Napi::Boolean>();
+		ensureIdle();
+		auto maxRows = info[0].As<Napi::Number>().Uint32Value();
+		auto buffers = getColumnBuffers(getTypeCast(info, 1));
+		auto count = fetchColumnBuffers(*buffers, maxRows);
+		return toColumnBatch(*buffers, count);
 	}
 
-	void executeDirect(const Napi::CallbackInfo &info)
+	/** same as fetchColumns, but rows are fetched into the column buffers on a worker thread */
+	Napi::Value fetchColumnsAsync(const Napi::CallbackInfo &info)
 	{
-		std::string query = info[0].As<Napi::String>().Utf8Value();
-		tci(TCIExecuteDirect(resultSet, &query[0], 1, 0));
+		ensureIdle();
+		auto maxRows = info[0].As<Napi::Number>().Uint32Value();
+		auto buffers = getColumnBuffers(getTypeCast(info, 1));
+		auto count = std::make_shared<uint32_t>(0);
+		return async([this, buffers, maxRows, count]()
+					 { *count = fetchColumnBuffers(*buffers, maxRows); },
+					 [this, buffers, count]()
+					 { return toColumnBatch(*buffers, *count); });
 	}
 
-	void prepare(const Napi::CallbackInfo &info)
+	/**
+	 * same as fetchRows, but rows are fetched into native column buffers on a worker thread
+	 * and converted to row objects on the main thread
+	 */
+	Napi::Value fetchRowsAsync(const Napi::CallbackInfo &info)
 	{
-		auto query = info[0].As<Napi::String>().Utf8Value();
-		tci(TCIPrepare(statement, &query[0]));
+		ensureIdle();
+		auto maxRows = info[0].As<Napi::Number>().Uint32Value();
+		auto buffers = getColumnBuffers(getTypeCast(info, 1));
+		auto count = std::make_shared<uint32_t>(0);
+		return async([this, buffers, maxRows, count]()
+					 { *count = fetchColumnBuffers(*buffers, maxRows); },
+					 [this, buffers, count]()
+					 { return toRows(*buffers, *count); });
 	}
 
-	void execute(const Napi::CallbackInfo &info)
+	/** typeCast argument at index, the connection setting if it is missing */
+	bool getTypeCast(const Napi::CallbackInfo &info, size_t index)
 	{
-		tci(TCIExecute(resultSet, 1, 0));
+		return info.Length() > index && !info[index].IsUndefined() ? info[index].ToBoolean().Value() : this->typeCast;
 	}
 
-	void setParam(const Napi::CallbackInfo &info)
+	/**
+	 * fetch up to maxRows rows into native column buffers without converting them to js values.
+	 * The cells are converted on access with getLazyValue. BLOB and CLOB columns are read like all others,
+	 * ResultSet does not fetch lazy rows for results with lobs.
+	 * @param maxRows maximum number of rows to fetch
+	 * @param typeCast optional typeCast override, the connection setting is used otherwise
+	 */
+	Napi::Value fetchLazy(const Napi::CallbackInfo &info)
 	{
-		setData(info[0], info[1]);
+		ensureIdle();
+		auto maxRows = info[0].As<Napi::Number>().Uint32Value();
+		auto buffers = getColumnBuffers(getTypeCast(info, 1));
+		auto count = fetchColumnBuffers(*buffers, maxRows);
+		return toLazyBatch(*buffers, count);
 	}
 
-	void beginTransaction(const Napi::CallbackInfo &info)
+	/** same as fetchLazy, but the rows are fetched on a worker thread */
+	Napi::Value fetchLazyAsync(const Napi::CallbackInfo &info)
 	{
-		tci(TCIBeginTransaction(transaction, connection));
+		ensureIdle();
+		auto maxRows = info[0].As<Napi::Number>().Uint32Value();
+		auto buffers = getColumnBuffers(getTypeCast(info, 1));
+		auto count = std::make_shared<uint32_t>(0);
+		return async([this, buffers, maxRows, count]()
+					 { *count = fetchColumnBuffers(*buffers, maxRows); },
+					 [this, buffers, count]()
+					 { return toLazyBatch(*buffers, *count); });
 	}
 
-	void commit(const Napi::CallbackInfo &info)
+	/** sha-256 ledger hash of the current row, the same as TransbaseLedger.hashLedgerRecord of example/transbase-ledger.js */
+	Napi::Value hashLedgerRecord(const Napi::CallbackInfo &info)
 	{
-		tci(TCICommitTransaction(transaction));
+		ensureIdle();
+		uint8_t digest[Sha256::SIZE];
+		hashLedgerRecord(digest);
+		return Napi::Buffer<uint8_t>::Copy(env, digest, Sha256::SIZE);
 	}
 
-	void rollback(const Napi::CallbackInfo &info)
+	/**
+	 * fetch up to maxRows rows and compute their ledger hashes natively, without converting any value to js.
+	 * @param maxRows maximum number of rows to fetch
+	 * @returns an array of 32 byte Buffers, empty if no more rows are found
+	 */
+	Napi::Value hashLedgerRecords(const Napi::CallbackInfo &info)
 	{
-		tci(TCIRollbackTransaction(transaction));
+		ensureIdle();
+		auto maxRows = info[0].As<Napi::Number>().Uint32Value();
+		std::string digests;
+		hashLedgerRecords(digests, maxRows);
+		return toDigests(digests);
 	}
 
-	void setData(Napi::Value nameOrPosition, Napi::Value value)
+	/** same as hashLedgerRecords, but the rows are fetched and hashed on a worker thread */
+	Napi::Value hashLedgerRecordsAsync(const Napi::CallbackInfo &info)
 	{
-		auto typeAndValue = getTciTypeAndValue(value);
-		auto type = typeAndValue.first;
-		auto data = typeAndValue.second;
-		auto size = sizeof(data);
+		ensureIdle();
+		auto maxRows = info[0].As<Napi::Number>().Uint32Value();
+		auto digests = std::make_shared<std::string>();
+		return async([this, digests, maxRows]()
+					 { hashLedgerRecords(*digests, maxRows); },
+					 [this, digests]()
+					 { return toDigests(*digests); });
+	}
 
-		if (nameOrPosition.IsNumber())
-		{
-			auto position = nameOrPosition.As<Napi::Number>().Uint32Value() + 1;
-			if (type == TCI_C_CHAR) // TODO: string handling get<std::string> require libcpp
-				tci(TCISetData(resultSet, position, value.ToString().Utf8Value().data(), size, type, NULL));
-			else if (type == TCI_C_BYTE)
-			{
-				auto buffer = value.As<Napi::Buffer<unsigned char>>();
-				tci(TCISetData(resultSet, position, buffer.Data(), buffer.Length(), type, NULL));
-			}
-			else
-				tci(TCISetData(resultSet, position, &data, size, type, NULL));
-		}
-		else
+	void hashLedgerRecords(std::string &digests, uint32_t maxRows)
+	{
+		Cancellable batch(cancellation, resultSet);
+		for (uint32_t count = 0; count < maxRows && fetch(TCI_FETCH_NEXT); count++)
 		{
-			auto name = nameOrPosition.As<Napi::String>().Utf8Value();
-			if (type == TCI_C_CHAR)
-				tci(TCISetDataByName(resultSet, &name[0], value.ToString().Utf8Value().data(), size, type, NULL));
-			else if (type == TCI_C_BYTE)
-			{
-				auto buffer = value.As<Napi::Buffer<unsigned char>>();
-				tci(TCISetDataByName(resultSet, &name[0], buffer.Data(), buffer.Length(), type, NULL));
-			}
-			else
-				tci(TCISetDataByName(resultSet, &name[0], &data, size, type, NULL));
+			digests.resize(digests.size() + Sha256::SIZE);
+			hashLedgerRecord((uint8_t *)&digests[digests.size() - Sha256::SIZE]);
 		}
+		stats.flush();
 	}
 
-	std::pair<Int2, std::variant<bool, int32_t, int64_t, double, std::string>> getTciTypeAndValue(Napi::Value value)
+	/**
+	 * hash every column but record_id of the current row as [0] if it IS NULL, otherwise [1] and its character representation.
+	 * BLOB and CLOB values are hashed in large chunks instead of being read whole.
+	 */
+	void hashLedgerRecord(uint8_t *digest)
 	{
-		if (value.IsBoolean())
-		{
-			return std::pair(TCI_C_INT1, value.As<Napi::Boolean>().Value());
-		}
-		else if (value.IsNumber())
+		static const Int4 LOB_CHUNK_SIZE = 64 * 1024;
+		Sha256 hash;
+		hash.update((uint8_t)0);
+		for (auto &column : getColumns())
 		{
-			auto number = value.As<Napi::Number>();
-			if (number.IsBigInt())
+			if (isRecordId(column.name))
+				continue;
+			switch (column.type)
+			{
+			case TCI_SQL_BLOB:
+			case TCI_SQL_CLOB:
 			{
-				return std::pair(TCI_C_INT8, value.As<Napi::Number>().Int64Value());
+				if (scratch.size() < (size_t)LOB_CHUNK_SIZE)
+					scratch.resize(LOB_CHUNK_SIZE);
+				auto bytes = readChunk(column.col, scratch.data(), LOB_CHUNK_SIZE);
+				hash.update((uint8_t)(isNull ? 0 : 1));
+				while (!isNull)
+				{
+					hash.update(scratch.data(), strnlen(scratch.data(), bytes));
+					if (state != TCI_DATA_TRUNCATION)
+						break;
+					bytes = readChunk(column.col, scratch.data(), LOB_CHUNK_SIZE);
+				}
+				break;
 			}
-			else if (isNapiValueInteger(env, number))
+			case TCI_SQL_BINARY:
+			case TCI_SQL_BITSHORT:
+			case TCI_SQL_BIT:
 			{
-				return std::pair(TCI_C_INT4, value.As<Napi::Number>().Int32Value());
+				auto bits = readBits(column.col);
+				hash.update((uint8_t)(isNull ? 0 : 1));
+				hash.update(bits.data(), bits.size());
+				break;
 			}
-			else
+			default:
 			{
-				return std::pair(TCI_C_DOUBLE, value.As<Napi::Number>().DoubleValue());
+				auto length = readChars(column.col, scratch, 0, 256);
+				hash.update((uint8_t)(isNull ? 0 : 1));
+				hash.update(scratch.data(), length);
+			}
 			}
 		}
-		else if (value.IsBuffer())
-		{
-			return std::pair(TCI_C_BYTE, -1);
-		}
-		else
-		{
-			return std::pair(TCI_C_CHAR, value.ToString().Utf8Value());
-		}
+		hash.finish(digest);
 	}
 
-	Napi::Value getQueryType(const Napi::CallbackInfo &info)
+	static bool isRecordId(const std::string &name)
 	{
-		auto queryType = getResultSetAttribute(TCI_ATTR_QUERY_TYPE);
-		if (sel_class(queryType))
-			return Napi::String::New(env, "SELECT");
-		if (upd_class(queryType))
-			return Napi::String::New(env, "UPDATE");
-		if (ddl_class(queryType))
-			return Napi::String::New(env, "SCHEMA");
-		return Napi::Number::New(env, queryType);
+		static const char RECORD_ID[] = "record_id";
+		return name.size() == sizeof(RECORD_ID) - 1 &&
+			   std::equal(name.begin(), name.end(), RECORD_ID, [](char a, char b)
+						  { return tolower((unsigned char)a) == b; });
 	}
 
-	Napi::Value getResultSetAttribute(const Napi::CallbackInfo &info)
+	Napi::Value toDigests(const std::string &digests)
 	{
-		auto attrKey = info[0].As<Napi::Number>().Uint32Value();
-		auto col = info.Length() > 1 ? info[1].As<Napi::Number>() : 1;
-		auto attr = getResultSetAttribute(attrKey, col);
-		return Napi::Number::New(env, attr);
+		auto count = digests.size() / Sha256::SIZE;
+		auto result = Napi::Array::New(env, count);
+		for (uint32_t i = 0; i < count; i++)
+			result.Set(i, Napi::Buffer<char>::Copy(env, digests.data() + i * Sha256::SIZE, Sha256::SIZE));
+		return result;
 	}
 
-	int getResultSetAttribute(int attrKey, int col = 1)
+	/** the batch of fetchLazy, its column buffers are owned by the js value and reported as external memory */
+	Napi::Value toLazyBatch(std::vector<ColumnBuffer> &buffers, uint32_t count)
 	{
-		Uint2 value = 0;
-		tci(TCIGetResultSetAttribute(resultSet, attrKey, col, &value, sizeof(value), NULL));
+		int64_t size = 0;
+		for (auto &buffer : buffers)
+			size += buffer.size();
+		auto finalize = [size](Napi::Env env, std::vector<ColumnBuffer> *columns)
+		{
+			Napi::MemoryManagement::AdjustExternalMemory(env, -size);
+			delete columns;
+		};
+		auto columns = new std::vector<ColumnBuffer>(std::move(buffers));
+		Napi::MemoryManagement::AdjustExternalMemory(env, size);
+		auto result = Napi::Object::New(env);
+		result.Set("length", count);
+		result.Set("columns", Napi::External<std::vector<ColumnBuffer>>::New(env, columns, finalize));
+		return result;
+	}
+
+	/** the js value of the cell at row and column index of a batch of fetchLazy, does not access the result set */
+	Napi::Value getLazyValue(const Napi::CallbackInfo &info)
+	{
+		auto &columns = *info[0].As<Napi::External<std::vector<ColumnBuffer>>>().Data();
+		auto row = info[1].As<Napi::Number>().Uint32Value();
+		auto index = info[2].As<Napi::Number>().Uint32Value();
+		if (index >= columns.size() || row >= columns[index].length)
+			throw Napi::RangeError::New(env, "no such cell in the fetched batch");
+		if (!stats.enabled)
+			return columns[index].getValue(env, row);
+		auto start = Stats::now();
+		auto value = columns[index].getValue(env, row);
+		stats.pendingConvert += Stats::now() - start; // published with the next batch
 		return value;
 	}
 
-	Napi::Value getVersionInfo(const Napi::CallbackInfo &info)
+	/**
+	 * fetch all rows of the current result set and write them to a file on a worker thread, @see Export
+	 * @param options {format, path | fd, header, delimiter, batchSize, typeCast}
+	 * @returns a promise of {rows, bytes}
+	 */
+	Napi::Value exportAsync(const Napi::CallbackInfo &info)
 	{
-		TCIVersion clientVersion;
-		tci(TCIGetEnvironmentAttribute(environment, TCI_ATTR_VERSION, 1, &clientVersion, sizeof(clientVersion), NULL));
-		TCIVersion serverVersion;
-		tci(TCIGetConnectionAttribute(connection, TCI_ATTR_VERSION, 1, &serverVersion, sizeof(serverVersion), NULL));
+		ensureIdle();
+		auto options = info[0].As<Napi::Object>();
+		auto exported = std::make_shared<Export>();
+		auto format = options.Get("format");
+		if (!format.IsUndefined() && !Export::parseFormat(format.ToString().Utf8Value(), exported->format))
+			throw Napi::TypeError::New(env, "export format must be one of csv, ndjson or arrow");
+		if (options.Get("fd").IsNumber())
+			exported->fd = options.Get("fd").As<Napi::Number>().Int32Value();
+		else if (options.Get("path").IsString())
+			exported->path = options.Get("path").As<Napi::String>().Utf8Value();
+		else
+			throw Napi::TypeError::New(env, "export requires a path or fd");
+		if (options.Has("header"))
+			exported->header = options.Get("header").ToBoolean().Value();
+		if (options.Get("delimiter").IsString())
+		{
+			auto delimiter = options.Get("delimiter").As<Napi::String>().Utf8Value();
+			if (delimiter.size() != 1)
+				throw Napi::TypeError::New(env, "export delimiter must be a single character");
+			exported->delimiter = delimiter[0];
+		}
+		if (options.Get("batchSize").IsNumber())
+			exported->batchSize = std::max(1u, options.Get("batchSize").As<Napi::Number>().Uint32Value());
 
-		auto version = Napi::Object::New(env);
-		version.Set("client", toVersion(clientVersion));
-		version.Set("server", toVersion(serverVersion));
-		return version;
+		auto typeCast = options.Get("typeCast");
+		auto buffers = std::make_shared<std::vector<ColumnBuffer>>();
+		for (auto &column : getColumns()) // datetimes are written as formatted by tci
+			buffers->emplace_back(column.col, column.type, column.name, typeCast.IsUndefined() ? this->typeCast : typeCast.ToBoolean().Value());
+		return async([this, exported, buffers]()
+					 { runExport(*exported, *buffers); },
+					 [this, exported]()
+					 {
+						 auto result = Napi::Object::New(env);
+						 result.Set("rows", (double)exported->rows);
+						 result.Set("bytes", (double)exported->bytes);
+						 return result;
+					 });
 	}
 
-	Napi::Value toVersion(TCIVersion &version)
+	void runExport(Export &exported, std::vector<ColumnBuffer> &buffers)
+	{
+		exported.begin(buffers);
+		uint32_t count;
+		while ((count = fetchColumnBuffers(buffers, exported.batchSize)) > 0)
+		{
+			Stats::Timer timer(stats, stats.convert);
+			exported.write(buffers, count);
+			for (auto &buffer : buffers)
+				buffer.clear();
+		}
+		exported.end();
+	}
+
+	/** empty column buffers of the current result set, must be called on the main thread */
+	std::shared_ptr<std::vector<ColumnBuffer>> getColumnBuffers(bool typeCast)
+	{
+		auto buffers = std::make_shared<std::vector<ColumnBuffer>>();
+		for (auto &column : getColumns())
+			buffers->emplace_back(column.col, column.type, column.name, typeCast, dateCast);
+		return buffers;
+	}
+
+	/** fetch up to maxRows rows into the column buffers, returns the number of fetched rows */
+	uint32_t fetchColumnBuffers(std::vector<ColumnBuffer> &buffers, uint32_t maxRows)
+	{
+		uint32_t count = 0;
+		Cancellable batch(cancellation, resultSet);
+		while (count < maxRows && fetch(TCI_FETCH_NEXT))
+		{
+			for (auto &buffer : buffers)
+				readColumnValue(buffer);
+			count++;
+		}
+		for (auto &buffer : buffers)
+			stats.accumulate(stats.pendingBytes, buffer.data.size());
+		stats.flush();
+		return count;
+	}
+
+	Napi::Value toColumnBatch(std::vector<ColumnBuffer> &buffers, uint32_t count)
 	{
+		Stats::Timer timer(stats, stats.convert);
 		auto result = Napi::Object::New(env);
-		result.Set("major", version.major_version);
-		result.Set("minor", version.minor_version);
-		result.Set("release", version.release);
-		result.Set("patch", version.patch);
-		result.Set("build", version.build);
+		auto columns = Napi::Array::New(env, buffers.size());
+		for (uint32_t i = 0; i < buffers.size(); i++)
+			columns.Set(i, buffers[i].toJs(env));
+		result.Set("length", count);
+		result.Set("columns", columns);
 		return result;
 	}
 
-	Napi::Value getResultSetStringAttribute(const Napi::CallbackInfo &info)
+	Napi::Value toRows(std::vector<ColumnBuffer> &buffers, uint32_t count)
 	{
-		Char value[MAXIDENTSIZE];
-		auto attrKey = info[0].As<Napi::Number>().Uint32Value();
-		auto col = info.Length() > 1 ? info[1].As<Napi::Number>() : 1;
-		tci(TCIGetResultSetAttribute(resultSet, attrKey, col, &value, sizeof(value), NULL));
-		return Napi::String::New(env, value);
+		return toRows(buffers, getColumnKeys(), 0, count);
 	}
 
-	Napi::Value fetch(const Napi::CallbackInfo &info)
+	/** row objects of count buffered rows from offset on */
+	Napi::Value toRows(std::vector<ColumnBuffer> &buffers, const std::vector<Napi::String> &keys, uint32_t offset, uint32_t count)
 	{
-		auto scrollMode = info.Length() > 0 ? info[0].As<Napi::Number>().Uint32Value() : TCI_FETCH_NEXT;
-
-		state = TCIFetch(resultSet, 1, scrollMode, 0);
-		if (state == TCI_SUCCESS)
-			return Napi::Boolean::New(env, true);
-		if (state == TCI_NO_DATA_FOUND)
-			return Napi::Boolean::New(env, false);
-		else
-			tci(state);
+		Stats::Timer timer(stats, stats.convert);
+		std::vector<StringInterner> interners(internStrings ? buffers.size() : 0);
+		auto rows = Napi::Array::New(env, count);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			auto row = Napi::Object::New(env);
+			for (size_t j = 0; j < buffers.size(); j++)
+				row.Set(keys[j], buffers[j].getValue(env, offset + i, internStrings ? &interners[j] : nullptr));
+			rows.Set(i, row);
+		}
+		return rows;
+	}
 
-		return env.Undefined();
+	/** append the value of the current row to a column buffer */
+	void readColumnValue(ColumnBuffer &column)
+	{
+		this->isNull = 0;
+		switch (column.kind)
+		{
+		case ColumnBuffer::DOUBLE:
+		{
+			double d;
+			tci(TCIGetData(resultSet, column.col, &d, sizeof(d), NULL, TCI_C_DOUBLE, &isNull));
+			column.push(&d, sizeof(d), isNull);
+			break;
+		}
+		case ColumnBuffer::FLOAT:
+		{
+			float f;
+			tci(TCIGetData(resultSet, column.col, &f, sizeof(f), NULL, TCI_C_FLOAT, &isNull));
+			double d = f;
+			column.push(&d, sizeof(d), isNull);
+			break;
+		}
+		case ColumnBuffer::INT32:
+		{
+			int32_t i;
+			tci(TCIGetData(resultSet, column.col, &i, sizeof(i), NULL, TCI_C_INT4, &isNull));
+			column.push(&i, sizeof(i), isNull);
+			break;
+		}
+		case ColumnBuffer::INT64:
+		{
+			int64_t ll;
+			tci(TCIGetData(resultSet, column.col, &ll, sizeof(ll), NULL, TCI_C_INT8, &isNull));
+			column.push(&ll, sizeof(ll), isNull);
+			break;
+		}
+		case ColumnBuffer::BOOL:
+		{
+			bool b;
+			tci(TCIGetData(resultSet, column.col, &b, sizeof(b), NULL, TCI_C_INT1, &isNull));
+			uint8_t u = b ? 1 : 0;
+			column.push(&u, sizeof(u), isNull);
+			break;
+		}
+		case ColumnBuffer::BYTES:
+		{
+			Int4 byteSize;
+			tci(TCIGetDataSize(resultSet, column.col, TCI_C_BYTE, &byteSize, &isNull));
+			if (!isNull && byteSize > 0)
+			{
+				auto offset = column.data.size();
+				column.data.resize(offset + byteSize);
+				tci(TCIGetData(resultSet, column.col, &column.data[offset], byteSize, NULL, TCI_C_BYTE, &isNull));
+			}
+			column.pushVariable(isNull);
+			break;
+		}
+		case ColumnBuffer::TEMPORAL:
+		{
+			double ms = 0;
+			readTemporal(column.col, *column.temporal, ms);
+			column.push(&ms, sizeof(ms), isNull);
+			break;
+		}
+		case ColumnBuffer::CHARS:
+		{
+			auto offset = column.data.size();
+			auto length = readChars(column.col, column.data, offset, column.width);
+			column.width = std::max(column.width, length + 1);
+			column.data.resize(offset + length);
+			column.pushVariable(isNull);
+			break;
+		}
+		}
 	}
 
 	Napi::Value getState(const Napi::CallbackInfo &info)
@@ -284,7 +5377,7 @@ public:
 		return Napi::Number::New(env, state);
 	}
 
-	Napi::Value getValue(TCIColumnnumber col, int sqlType, bool typeCast)
+	Napi::Value getValue(TCIColumnnumber col, int sqlType, bool typeCast, StringInterner *interner = nullptr)
 	{
 		if (!typeCast)
 		{
@@ -296,7 +5389,7 @@ public:
 			case TCI_SQL_BIT:
 				return getBitsValue(col);
 			default:
-				return getStringValue(col);
+				return getStringValue(col, interner);
 			}
 		}
 
@@ -327,8 +5420,16 @@ public:
 		case TCI_SQL_CHAR:
 		case TCI_SQL_VARCHAR:
 		case TCI_SQL_CLOB:
+			return getStringValue(col, interner);
+		// datetime and timespan, other types as formatted by tci
 		default:
-			return getStringValue(col);
+			if (dateCast != Temporal::STRING)
+			{
+				auto temporal = Temporal::of(sqlType);
+				if (temporal)
+					return getTemporalValue(col, *temporal);
+			}
+			return getStringValue(col, interner);
 		}
 	}
 
@@ -336,9 +5437,17 @@ public:
 	{
 		TCIColumnnumber col = info[0].As<Napi::Number>().Uint32Value();
 		auto sqlType = info[1].As<Napi::Number>().Uint32Value();
+		ensureIdle();
 		auto typeCast = info.Length() == 3 ? info[2].As<Napi::Boolean>() : this->typeCast;
 		this->isNull = 0;
+		if (!stats.enabled)
+		{
+			auto value = getValue(col, sqlType, typeCast);
+			return isNull ? env.Null() : value;
+		}
+		auto start = Stats::now();
 		auto value = getValue(col, sqlType, typeCast);
+		stats.pendingConvert += Stats::now() - start; // published with the next fetch
 		return isNull ? env.Null() : value;
 	}
 
@@ -346,11 +5455,57 @@ public:
 	{
 		TCIColumnnumber col = info[0].As<Napi::Number>().Uint32Value();
 		auto bufferSize = info[1].As<Napi::Number>().Int32Value();
+		ensureIdle();
 		this->isNull = 0;
 		Napi::Value value = getBufferValue(col, bufferSize);
 		return isNull ? env.Null() : value;
 	}
 
+	/**
+	 * read the next chunk of a value into the given buffer in place.
+	 * Returns the number of bytes read or null, the state is DATA_TRUNCATION if there is more data.
+	 */
+	Napi::Value getValueInto(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		TCIColumnnumber col = info[0].As<Napi::Number>().Uint32Value();
+		auto buffer = info[1].As<Napi::Buffer<char>>();
+		auto bytes = readChunk(col, buffer.Data(), (Int4)buffer.Length());
+		return isNull ? env.Null() : Napi::Number::New(env, bytes);
+	}
+
+	/** same as getValueInto, but the chunk is read on a worker thread */
+	Napi::Value getValueIntoAsync(const Napi::CallbackInfo &info)
+	{
+		TCIColumnnumber col = info[0].As<Napi::Number>().Uint32Value();
+		auto buffer = info[1].As<Napi::Buffer<char>>();
+		auto data = buffer.Data();
+		auto size = (Int4)buffer.Length();
+		auto keep = std::make_shared<Napi::ObjectReference>(Napi::Persistent(buffer.As<Napi::Object>()));
+		auto bytes = std::make_shared<Int4>(0);
+		return async([this, col, data, size, bytes]()
+					 { *bytes = readChunk(col, data, size); },
+					 [this, keep, bytes]()
+					 {
+						 keep->Reset(); // the buffer may be collected again
+						 return isNull ? env.Null() : Napi::Number::New(env, *bytes);
+					 });
+	}
+
+	/** read the next chunk of a value into data, returns the number of bytes read */
+	Int4 readChunk(TCIColumnnumber col, char *data, Int4 size)
+	{
+		Int4 byteSize = 0;
+		this->isNull = 0;
+		this->state = TCIGetData(resultSet, col, data, size, &byteSize, TCI_C_CHAR, &isNull);
+		if (this->state != TCI_DATA_TRUNCATION)
+		{
+			tci(this->state); // error handling
+		}
+		stats.count(stats.lobBytes, std::min(byteSize, size));
+		return std::min(byteSize, size);
+	}
+
 	Napi::Value getBooleanValue(TCIColumnnumber &colNumber)
 	{
 		bool b;
@@ -396,52 +5551,98 @@ public:
 	}
 
 	Napi::Value getBitsValue(TCIColumnnumber &colNumber)
+	{
+		return Napi::String::New(env, readBits(colNumber));
+	}
+
+	/** the character representation of a binary or bits value, empty if it IS NULL */
+	std::string readBits(TCIColumnnumber col)
 	{
 		Int4 bitsSize;
-		tci(TCIGetDataSize(resultSet, colNumber, TCI_C_CHAR, &bitsSize, &isNull));
-		std::string str(bitsSize - 2, '0');
-		tci(TCIGetData(resultSet, colNumber, str.data(), bitsSize, NULL, TCI_C_CHAR, &isNull));
-		return Napi::String::New(env, str);
+		tci(TCIGetDataSize(resultSet, col, TCI_C_CHAR, &bitsSize, &isNull));
+		if (isNull || bitsSize < 2)
+			return "";
+		std::string str(bitsSize, '0');
+		tci(TCIGetData(resultSet, col, str.data(), bitsSize, NULL, TCI_C_CHAR, &isNull));
+		str.resize(bitsSize - 2);
+		return str;
 	}
 
 	Napi::Value getBufferValue(TCIColumnnumber &colNumber, Int4 &bufferSize)
 	{
-		Int4 byteSize;
-		auto buffer = Napi::Buffer<unsigned char>::New(env, bufferSize);
-		this->state = TCIGetData(resultSet, colNumber, buffer.Data(), bufferSize, &byteSize, TCI_C_CHAR, &isNull);
-		if (this->state != TCI_DATA_TRUNCATION)
-		{
-			tci(this->state); // error handling
-		}
-		if (bufferSize == byteSize)
-		{
-			return buffer;
-		}
-		else
+		// read into the reused scratch buffer and copy only the bytes read,
+		// instead of allocating a js buffer of bufferSize for every chunk
+		if (scratch.size() < (size_t)bufferSize)
+			scratch.resize(bufferSize);
+		auto bytes = readChunk(colNumber, scratch.data(), bufferSize);
+		return Napi::Buffer<char>::Copy(env, scratch.data(), bytes);
+	}
+
+	Napi::Value getStringValue(TCIColumnnumber &colNumber, StringInterner *interner = nullptr)
+	{
+		auto length = readChars(colNumber, scratch, 0, 256);
+		if (isNull)
+			return env.Null();
+		stats.accumulate(stats.pendingBytes, length);
+		if (interner)
+			return interner->get(env, scratch.data(), length);
+		return newString(env, scratch.data(), length);
+	}
+
+	/**
+	 * read a whole character value into buffer at offset, with a single TCIGetData call if it fits into width bytes.
+	 * The buffer is only grown and read on if the value was truncated.
+	 * Returns the length of the value in bytes, the buffer may be left larger than offset + length.
+	 */
+	template <typename Buffer>
+	size_t readChars(TCIColumnnumber col, Buffer &buffer, size_t offset, size_t width)
+	{
+		if (buffer.size() < offset + width)
+			buffer.resize(offset + width);
+		auto end = offset;
+		this->isNull = 0;
+		while ((this->state = TCIGetData(resultSet, col, &buffer[end], (Int4)(buffer.size() - end), NULL, TCI_C_CHAR, &isNull)) == TCI_DATA_TRUNCATION)
 		{
-			return buffer.Copy(env, buffer.Data(), byteSize);
+			end += strnlen(&buffer[end], buffer.size() - end);
+			buffer.resize(offset + 2 * (buffer.size() - offset));
 		}
+		tci(this->state);
+		if (isNull)
+			return 0;
+		return end + strnlen(&buffer[end], buffer.size() - end) - offset;
 	}
 
-	Napi::Value getStringValue(TCIColumnnumber &colNumber)
+	Napi::Value getTemporalValue(TCIColumnnumber &colNumber, const Temporal &temporal)
 	{
-		Int4 charLength;
-		Int4 byteSize;
-		tci(TCIGetDataSize(resultSet, colNumber, TCI_C_CHAR, &byteSize, &isNull));
-		tci(TCIGetDataCharLength(resultSet, colNumber, &charLength, &isNull));
-		auto size = std::max(charLength, byteSize) + 1;
-		if (isNull)
+		double ms;
+		if (!readTemporal(colNumber, temporal, ms))
 			return env.Null();
-		if (byteSize == 0 || charLength == 0)
-			return Napi::String::New(env, "");
+#if NAPI_VERSION > 4
+		if (dateCast == Temporal::DATE && temporal.isDate())
+			return Napi::Date::New(env, ms);
+#endif
+		return Napi::Number::New(env, ms);
+	}
 
-		std::string str(charLength, ' ');
-		tci(TCIGetData(resultSet, colNumber, str.data(), size, NULL, TCI_C_CHAR, &isNull));
-		return Napi::String::New(env, str);
+	/** read a datetime or timespan value as milliseconds, returns false if it is null */
+	bool readTemporal(TCIColumnnumber col, const Temporal &temporal, double &ms)
+	{
+		Char text[64];
+		this->isNull = 0;
+		tci(TCIGetData(resultSet, col, text, sizeof(text), NULL, TCI_C_CHAR, &isNull));
+		if (isNull)
+			return false;
+		if (!temporal.parse(text, ms))
+		{
+			snprintf(errorMessage, sizeof(errorMessage), "unexpected %s value '%s'", Description::typeName(temporal.type).c_str(), text);
+			fail();
+		}
+		return true;
 	}
 
 	Napi::Value getIsNull(const Napi::CallbackInfo &info)
 	{
+		ensureIdle();
 		TCIColumnnumber colNumber = info[0].As<Napi::Number>().Uint32Value();
 		Int4 byteSize;
 		tci(TCIGetDataSize(resultSet, colNumber, TCI_C_CHAR, &byteSize, &isNull));
@@ -450,38 +5651,149 @@ public:
 
 	void close(const Napi::CallbackInfo &info)
 	{
+		ensureIdle();
+		if (stats.enabled)
+			stats.endQuery();
 		free();
 	}
 
+	void setStatsEnabled(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
+		stats.enabled = info[0].ToBoolean().Value();
+	}
+
+	/** latency histograms in milliseconds and counters, available while the connection is busy */
+	Napi::Value getStats(const Napi::CallbackInfo &info)
+	{
+		return stats.toJs(env);
+	}
+
+	void resetStats(const Napi::CallbackInfo &info)
+	{
+		stats.reset();
+	}
+
 	void free()
 	{
-		if (resultSet)
-		{
-			TCIClose(resultSet);
-			TCIFreeResultSet(resultSet);
-		}
-		if (statement)
-		{
-			TCIFreeStatement(statement);
-		}
-		if (transaction)
+		restoreHandles();
+		handlePool->close();
+		handlePool = std::make_shared<HandlePool>();
+		lobs.clear();
+		results.clear();
+		if (sharedPool && connection)
 		{
-			TCIFreeTransaction(transaction);
+			TCIRollbackTransaction(transaction); // an open transaction is not handed to the next borrower
+			sharedPool->release(takeSession());
 		}
+		else
+			takeSession().close();
+		sharedPool.reset();
+	}
+
+	/** move the handles of the connection out, the connection is closed afterwards */
+	Session takeSession()
+	{
+		useDirect();
+		Session session;
+		session.environment = std::move(environment);
+		session.error = error;
+		session.connection = connection;
+		session.transaction = transaction;
+		session.directStatement = directStatement;
+		session.directResultSet = directResultSet;
+		session.statements = std::move(statements);
+		error = NULL;
+		connection = NULL;
+		transaction = NULL;
+		directStatement = NULL;
+		directResultSet = NULL;
+		statement = NULL;
+		resultSet = NULL;
+		statements = StatementCache();
+		statements.capacity = session.statements.capacity;
+		return session;
+	}
+
+	/** continue on the handles of a borrowed session, its prepared statements are kept up to the own cache size */
+	void adoptSession(Session &session)
+	{
+		environment = std::move(session.environment);
+		error = session.error;
+		connection = session.connection;
+		transaction = session.transaction;
+		directStatement = session.directStatement;
+		directResultSet = session.directResultSet;
+		auto capacity = statements.capacity;
+		statements = std::move(session.statements);
+		statements.capacity = capacity;
+		directPlan = BindPlan();
+		directDescription.reset();
+		useDirect();
+		while (statements.entries.size() > statements.capacity)
+			freeStatement(statements.evict());
+	}
+
+	/**
+	 * borrow a session of a SharedPool on a worker thread instead of logging in, it is given back on close
+	 * @param name the name the pool is registered with
+	 * @returns a promise of false if all sessions of the pool are borrowed, it does not wait for one
+	 */
+	Napi::Value borrowAsync(const Napi::CallbackInfo &info)
+	{
+		ensureIdle();
 		if (connection)
+			throw Napi::Error::New(env, "the connection is open already");
+		auto name = info[0].ToString().Utf8Value();
+		auto pool = SharedPool::get(name);
+		if (!pool)
+			throw Napi::Error::New(env, "no shared pool named " + name + " is registered");
+		auto borrowed = std::make_shared<bool>(false);
+		return async([this, pool, borrowed]()
+					 { *borrowed = borrow(pool); },
+					 [this, borrowed]()
+					 { return Napi::Boolean::New(env, *borrowed); });
+	}
+
+	bool borrow(std::shared_ptr<SharedPool> pool)
+	{
+		Session session;
+		auto acquired = pool->acquire(session);
+		if (acquired == SharedPool::NONE)
+			return false;
+		if (acquired == SharedPool::IDLE)
 		{
-			TCILogout(connection);
-			TCIDisconnect(connection);
-			TCIFreeConnection(connection);
+			adoptSession(session);
+			sharedPool = pool;
+			return true;
 		}
-		if (error)
+		try
 		{
-			TCIFreeError(error);
+			open({pool->url, pool->user, pool->password, pool->environment});
 		}
-		if (environment)
+		catch (...)
 		{
-			TCIFreeEnvironment(environment);
+			takeSession().close();
+			pool->abandon();
+			throw;
 		}
+		sharedPool = pool;
+		return true;
+	}
+
+	/** queue work on a worker thread and return a promise resolved with the complete callback's value */
+	Napi::Value async(std::function<void()> work, std::function<Napi::Value()> complete = nullptr)
+	{
+		ensureIdle();
+		auto worker = new Worker(this, work, complete);
+		worker->Queue();
+		return worker->Promise();
+	}
+
+	void ensureIdle()
+	{
+		if (busy)
+			throw Napi::Error::New(env, "connection is busy with an asynchronous operation");
 	}
 
 	void tci(TCIState state)
@@ -489,23 +5801,22 @@ public:
 		this->state = state;
 		if (state)
 		{
+			if (cancellation.running.load(std::memory_order_relaxed) && cancellation.reason.load())
+				cancelled(); // failed because it was cancelled
 			TCIGetError(error, 1, 1, errorMessage, sizeof(errorMessage), &errorCode, sqlcode);
-			printf("TCIError %d: %s\n SQLCode: %s\n", errorCode, errorMessage, sqlcode);
-			throw Napi::Error::New(env, errorMessage);
+			stats.error(sqlcode, sizeof(sqlcode));
+			fail();
 		}
 	}
 
-	static bool isNapiValueInteger(Napi::Env &env, Napi::Value &num)
+	/** raise the current errorMessage, as native exception on worker threads or as js error otherwise */
+	void fail()
 	{
-		return env.Global()
-			.Get("Number")
-			.ToObject()
-			.Get("isInteger")
-			.As<Napi::Function>()
-			.Call({num})
-			.ToBoolean()
-			.Value();
+		if (offThread)
+			throw std::runtime_error(errorMessage);
+		throw Napi::Error::New(env, errorMessage);
 	}
+
 };
 
 static void DefineConstants(Napi::Env env, Napi::Object exports)
@@ -525,71 +5836,8 @@ static void DefineConstants(Napi::Env env, Napi::Object exports)
 	exports.Set("State", state);
 
 	auto sqlType = Napi::Object::New(env);
-	sqlType.Set("BOOL", TCI_SQL_BOOL);
-	sqlType.Set("TINYINT", TCI_SQL_TINYINT);
-	sqlType.Set("SMALLINT", TCI_SQL_SMALLINT);
-	sqlType.Set("INTEGER", TCI_SQL_INTEGER);
-	sqlType.Set("NUMERIC", TCI_SQL_NUMERIC);
-	sqlType.Set("FLOAT", TCI_SQL_FLOAT);
-	sqlType.Set("DOUBLE", TCI_SQL_DOUBLE);
-	sqlType.Set("CHAR", TCI_SQL_CHAR);
-	sqlType.Set("VARCHAR", TCI_SQL_VARCHAR);
-	sqlType.Set("BINARY", TCI_SQL_BINARY);
-	sqlType.Set("BIT", TCI_SQL_BIT);
-	sqlType.Set("BLOB", TCI_SQL_BLOB);
-	sqlType.Set("BITSHORT", TCI_SQL_BITSHORT);
-	sqlType.Set("BIGINT", TCI_SQL_BIGINT);
-	sqlType.Set("CLOB", TCI_SQL_CLOB);
-	sqlType.Set("DATE", TCI_SQL_DATE);
-	sqlType.Set("DATE_YEAR", TCI_SQL_DATE_YEAR);
-	sqlType.Set("DATE_YEAR_TO_MONTH", TCI_SQL_DATE_YEAR_TO_MONTH);
-	sqlType.Set("DATE_YEAR_TO_DAY", TCI_SQL_DATE_YEAR_TO_DAY);
-	sqlType.Set("DATE_YEAR_TO_HOUR", TCI_SQL_DATE_YEAR_TO_HOUR);
-	sqlType.Set("DATE_YEAR_TO_MINUTE", TCI_SQL_DATE_YEAR_TO_MINUTE);
-	sqlType.Set("DATE_YEAR_TO_SECOND", TCI_SQL_DATE_YEAR_TO_SECOND);
-	sqlType.Set("DATE_YEAR_TO_MILLISECOND", TCI_SQL_DATE_YEAR_TO_MILLISECOND);
-	sqlType.Set("DATE_MONTH", TCI_SQL_DATE_MONTH);
-	sqlType.Set("DATE_MONTH_TO_DAY", TCI_SQL_DATE_MONTH_TO_DAY);
-	sqlType.Set("DATE_MONTH_TO_HOUR", TCI_SQL_DATE_MONTH_TO_HOUR);
-	sqlType.Set("DATE_MONTH_TO_MINUTE", TCI_SQL_DATE_MONTH_TO_MINUTE);
-	sqlType.Set("DATE_MONTH_TO_SECOND", TCI_SQL_DATE_MONTH_TO_SECOND);
-	sqlType.Set("DATE_MONTH_TO_MILLISECOND", TCI_SQL_DATE_MONTH_TO_MILLISECOND);
-	sqlType.Set("DATE_DAY", TCI_SQL_DATE_DAY);
-	sqlType.Set("DATE_DAY_TO_HOUR", TCI_SQL_DATE_DAY_TO_HOUR);
-	sqlType.Set("DATE_DAY_TO_MINUTE", TCI_SQL_DATE_DAY_TO_MINUTE);
-	sqlType.Set("DATE_DAY_TO_SECOND", TCI_SQL_DATE_DAY_TO_SECOND);
-	sqlType.Set("DATE_DAY_TO_MILLISECOND", TCI_SQL_DATE_DAY_TO_MILLISECOND);
-	sqlType.Set("DATE_HOUR", TCI_SQL_DATE_HOUR);
-	sqlType.Set("DATE_HOUR_TO_MINUTE", TCI_SQL_DATE_HOUR_TO_MINUTE);
-	sqlType.Set("DATE_HOUR_TO_SECOND", TCI_SQL_DATE_HOUR_TO_SECOND);
-	sqlType.Set("DATE_HOUR_TO_MILLISECOND", TCI_SQL_DATE_HOUR_TO_MILLISECOND);
-	sqlType.Set("DATE_MINUTE", TCI_SQL_DATE_MINUTE);
-	sqlType.Set("DATE_MINUTE_TO_SECOND", TCI_SQL_DATE_MINUTE_TO_SECOND);
-	sqlType.Set("DATE_MINUTE_TO_MILLISECOND", TCI_SQL_DATE_MINUTE_TO_MILLISECOND);
-	sqlType.Set("DATE_SECOND", TCI_SQL_DATE_SECOND);
-	sqlType.Set("DATE_SECOND_TO_MILLISECOND", TCI_SQL_DATE_SECOND_TO_MILLISECOND);
-	sqlType.Set("DATE_MILLISECOND", TCI_SQL_DATE_MILLISECOND);
-	sqlType.Set("TIME", TCI_SQL_TIME);
-	sqlType.Set("TIMESTAMP", TCI_SQL_TIMESTAMP);
-	sqlType.Set("INTERVAL", TCI_SQL_TYPE_INTERVAL);
-	sqlType.Set("INTERVAL_YEAR", TCI_SQL_INTERVAL_YEAR);
-	sqlType.Set("INTERVAL_YEAR_TO_MONTH", TCI_SQL_INTERVAL_YEAR_TO_MONTH);
-	sqlType.Set("INTERVAL_MONTH", TCI_SQL_INTERVAL_MONTH);
-	sqlType.Set("INTERVAL_DAY", TCI_SQL_INTERVAL_DAY);
-	sqlType.Set("INTERVAL_DAY_TO_HOUR", TCI_SQL_INTERVAL_DAY_TO_HOUR);
-	sqlType.Set("INTERVAL_DAY_TO_MINUTE", TCI_SQL_INTERVAL_DAY_TO_MINUTE);
-	sqlType.Set("INTERVAL_DAY_TO_SECOND", TCI_SQL_INTERVAL_DAY_TO_SECOND);
-	sqlType.Set("INTERVAL_DAY_TO_MILLISECOND", TCI_SQL_INTERVAL_DAY_TO_MILLISECOND);
-	sqlType.Set("INTERVAL_HOUR", TCI_SQL_INTERVAL_HOUR);
-	sqlType.Set("INTERVAL_HOUR_TO_MINUTE", TCI_SQL_INTERVAL_HOUR_TO_MINUTE);
-	sqlType.Set("INTERVAL_HOUR_TO_SECOND", TCI_SQL_INTERVAL_HOUR_TO_SECOND);
-	sqlType.Set("INTERVAL_HOUR_TO_MILLISECOND", TCI_SQL_INTERVAL_HOUR_TO_MILLISECOND);
-	sqlType.Set("INTERVAL_MINUTE", TCI_SQL_INTERVAL_MINUTE);
-	sqlType.Set("INTERVAL_MINUTE_TO_SECOND", TCI_SQL_INTERVAL_MINUTE_TO_SECOND);
-	sqlType.Set("INTERVAL_MINUTE_TO_MILLISECOND", TCI_SQL_INTERVAL_MINUTE_TO_MILLISECOND);
-	sqlType.Set("INTERVAL_SECOND", TCI_SQL_INTERVAL_SECOND);
-	sqlType.Set("INTERVAL_SECOND_TO_MILLISECOND", TCI_SQL_INTERVAL_SECOND_TO_MILLISECOND);
-	sqlType.Set("INTERVAL_MILLISECOND", TCI_SQL_INTERVAL_MILLISECOND);
+	for (auto &sqlTypeName : SQL_TYPES)
+		sqlType.Set(sqlTypeName.name, sqlTypeName.type);
 
 	exports.Set("SqlType", sqlType);
 }
@@ -597,7 +5845,19 @@ static void DefineConstants(Napi::Env env, Napi::Object exports)
 // Initialize native add-on
 Napi::Object Init(Napi::Env env, Napi::Object exports)
 {
+#if NAPI_VERSION > 5
+	auto addon = new Addon();
+	addon->environment = Napi::Persistent(Environment::Init(env, exports));
+	addon->cursor = Napi::Persistent(Cursor::Init(env, exports));
+	env.SetInstanceData(addon); // deleted when the environment is torn down
+	exports.Set("setErrorClasses", Napi::Function::New(env, Addon::setErrorClasses));
+#else
+	Environment::Init(env, exports);
+	Cursor::Init(env, exports);
+#endif
 	TCI::Init(env, exports);
+	LedgerWorker::Init(env, exports);
+	SharedPool::Init(env, exports);
 	DefineConstants(env, exports);
 	return exports;
 }
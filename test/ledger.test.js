@@ -1,5 +1,6 @@
 const assert = require("assert").strict;
 const { TransbaseLedger } = require("../example/transbase-ledger");
+const { Ledger } = require("../transbase");
 
 describe("TransbaseLedger", () => {
   it("can hash ledger nodes", () => {
@@ -139,4 +140,89 @@ describe("TransbaseLedger", () => {
       );
     });
   });
+
+  describe("native proof verification", () => {
+    const foo = Buffer.alloc(32, "foo");
+    const baz = Buffer.alloc(32, "baz");
+    const path = [
+      {
+        hash: foo.toString("hex"),
+        first: true,
+        old: 1,
+        new: 1,
+      },
+      {
+        hash: baz.toString("hex"),
+        first: false,
+        old: null,
+        new: 2,
+      },
+    ];
+    const transbase = { query: () => ({ toArray: () => path }) };
+    const recordHash = Buffer.alloc(32, 2);
+    const ledgerHash = TransbaseLedger.hashLedgerNodes(
+      TransbaseLedger.hashLedgerNodes(foo, recordHash),
+      baz
+    );
+
+    it("verifies audit proofs like verifyAuditProof", async () => {
+      const records = [
+        { ledgerHash, recordHash },
+        { ledgerHash, recordHash: Buffer.alloc(32, 3) },
+        { ledgerHash: ledgerHash.toString("hex"), recordHash },
+      ];
+      const valid = await TransbaseLedger.verifyAuditProofs(
+        transbase,
+        records,
+        { threads: 2, ledger: Ledger }
+      );
+      assert.deepEqual(valid, [true, false, true]);
+      assert.deepEqual(
+        valid.slice(0, 2),
+        records
+          .slice(0, 2)
+          .map((record) => TransbaseLedger.verifyAuditProof(transbase, record))
+      );
+    });
+
+    it("verifies consistency proofs like verifyConsistencyProof", async () => {
+      const ledgers = [
+        {
+          ledgerHashOld: foo,
+          ledgerHashNew: TransbaseLedger.hashLedgerNodes(foo, baz),
+        },
+        { ledgerHashOld: foo, ledgerHashNew: ledgerHash },
+      ];
+      const valid = await TransbaseLedger.verifyConsistencyProofs(
+        transbase,
+        ledgers,
+        { ledger: Ledger }
+      );
+      assert.deepEqual(valid, [true, false]);
+      assert.deepEqual(
+        valid,
+        ledgers.map((ledger) =>
+          TransbaseLedger.verifyConsistencyProof(transbase, ledger)
+        )
+      );
+    });
+
+    it("resolves an empty array without proofs", async () => {
+      assert.deepEqual(await Ledger.verifyAuditProofs([]), []);
+    });
+
+    it("rejects hashes of other than 32 bytes and bad path nodes", () => {
+      const proof = { ledgerHash, recordHash, path };
+      for (const hash of [Buffer.from([2]), recordHash.toString("hex") + "0"]) {
+        assert.throws(
+          () => Ledger.verifyAuditProofs([{ ...proof, recordHash: hash }]),
+          /hex string of 32 bytes/
+        );
+      }
+      assert.throws(
+        () => Ledger.verifyAuditProofs([{ ...proof, path: [1] }]),
+        /must be an object/
+      );
+    });
+  });
 });
@@ -0,0 +1,168 @@
+const assert = require("assert").strict;
+const { Worker } = require("worker_threads");
+const {
+  Transbase,
+  TransbasePool,
+  SharedPool,
+  getTransferList,
+} = require("../transbase");
+const config = require("./config");
+
+describe("TransbasePool", () => {
+  let pool;
+
+  before(async () => {
+    pool = await TransbasePool.create({ ...config, size: 2, max: 3 });
+  });
+
+  after(() => pool.close());
+
+  it("pre-connects the configured number of connections", () => {
+    assert.deepEqual(pool.getStats(), { connections: 2, idle: 2, waiters: 0 });
+  });
+
+  it("runs queries on parallel connections", async () => {
+    const results = await Promise.all(
+      Array.from({ length: 6 }, () =>
+        pool.query("select tname from systable where tname = ?", ["systable"])
+      )
+    );
+    results.forEach((rows) => assert.equal(rows.length, 1));
+    assert.ok(pool.getStats().connections <= 3);
+  });
+
+  it("times out if no connection becomes idle", async () => {
+    const small = await TransbasePool.create({
+      ...config,
+      size: 1,
+      acquireTimeout: 10,
+    });
+    try {
+      const transbase = await small.acquire();
+      await assert.rejects(small.acquire(), /acquire timeout/);
+      small.release(transbase);
+    } finally {
+      await small.close();
+    }
+  });
+
+  it("rejects acquire calls above maxWaiters", async () => {
+    const small = await TransbasePool.create({
+      ...config,
+      size: 1,
+      maxWaiters: 0,
+    });
+    try {
+      const transbase = await small.acquire();
+      await assert.rejects(small.acquire(), /pool exhausted/);
+      small.release(transbase);
+    } finally {
+      await small.close();
+    }
+  });
+});
+
+describe("SharedPool", () => {
+  const NAME = `shared_${String(Math.random()).substring(2, 12)}`;
+
+  before(() => SharedPool.register(NAME, { ...config, max: 2 }));
+
+  after(() => SharedPool.unregister(NAME));
+
+  it("reuses sessions given back", async () => {
+    const first = await Transbase.borrow(NAME);
+    const second = await Transbase.borrow(NAME);
+    assert.deepEqual(SharedPool.getStats(NAME), {
+      max: 2,
+      borrowed: 2,
+      idle: 0,
+    });
+    first.close();
+    second.close();
+    assert.deepEqual(SharedPool.getStats(NAME), {
+      max: 2,
+      borrowed: 0,
+      idle: 2,
+    });
+    const third = await Transbase.borrow(NAME);
+    try {
+      const rows = third.query("select tname from systable").toArray();
+      assert.ok(rows.length > 0);
+      assert.equal(SharedPool.getStats(NAME).idle, 1);
+    } finally {
+      third.close();
+    }
+  });
+
+  it("times out while all sessions are borrowed", async () => {
+    const borrowed = [
+      await Transbase.borrow(NAME),
+      await Transbase.borrow(NAME),
+    ];
+    try {
+      await assert.rejects(
+        Transbase.borrow(NAME, { acquireTimeout: 10 }),
+        /acquire timeout/
+      );
+    } finally {
+      borrowed.forEach((transbase) => transbase.close());
+    }
+  });
+
+  it("hands a session given back to a waiting borrow", async () => {
+    const first = await Transbase.borrow(NAME);
+    const second = await Transbase.borrow(NAME);
+    const waiting = Transbase.borrow(NAME, { acquireTimeout: 5000 });
+    setTimeout(() => first.close(), 10);
+    const third = await waiting;
+    try {
+      assert.equal(SharedPool.getStats(NAME).borrowed, 2);
+    } finally {
+      second.close();
+      third.close();
+    }
+  });
+
+  it("rejects unknown and duplicate names", async () => {
+    await assert.rejects(Transbase.borrow(`${NAME}_unknown`), /no shared pool/);
+    assert.throws(
+      () => SharedPool.register(NAME, config),
+      /registered already/
+    );
+    assert.equal(SharedPool.getStats(`${NAME}_unknown`), undefined);
+  });
+
+  it("is shared with worker threads", async () => {
+    const worker = new Worker(
+      `
+      const { parentPort, workerData } = require("worker_threads");
+      const { Transbase, getTransferList } = require(workerData.module);
+      (async () => {
+        const transbase = await Transbase.borrow(workerData.name);
+        try {
+          const resultSet = transbase.query("select tname from systable");
+          const batch = resultSet.fetchColumns();
+          parentPort.postMessage(batch, getTransferList(batch));
+        } finally {
+          transbase.close();
+        }
+      })();
+      `,
+      {
+        eval: true,
+        workerData: { module: require.resolve("../transbase"), name: NAME },
+      }
+    );
+    const [batch] = await Promise.all([
+      new Promise((resolve, reject) => {
+        worker.once("message", resolve);
+        worker.once("error", reject);
+      }),
+      new Promise((resolve) => worker.once("exit", resolve)),
+    ]);
+    assert.ok(batch.length > 0);
+    assert.equal(batch.columns[0].name, "tname");
+    assert.ok(getTransferList(batch).length > 0);
+    assert.equal(SharedPool.getStats(NAME).borrowed, 0);
+  });
+});
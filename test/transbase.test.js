@@ -1,5 +1,5 @@
 const assert = require("assert").strict;
-const { Transbase } = require("../transbase");
+const { Transbase, TimeoutError, AbortError } = require("../transbase");
 const config = require("./config");
 
 describe("Transbase.query", () => {
@@ -99,6 +99,48 @@ describe("Transbase.query", () => {
         .toArray();
       assert.equal(result[0].comment, null);
     });
+
+    it("decodes unicode, empty and long strings", () => {
+      const long = "x".repeat(1000) + "ä";
+      const result = client
+        .query(`select comment, '${long}' as long from ${TABLE} where nr <= 4`)
+        .toArray();
+      assert.deepEqual(
+        result.map((row) => row.comment),
+        ["Withdrawal", "Lunch🚀", "Drink", ""]
+      );
+      assert.equal(result[3].long, long);
+    });
+
+    it("can intern repeated strings", () => {
+      const interning = new Transbase({ ...config, internStrings: true });
+      try {
+        const result = interning
+          .query(`select 'status' as s, comment from ${TABLE}`)
+          .toArray();
+        assert.ok(result.every((row) => row.s === "status"));
+        assert.equal(result[1].comment, "Lunch🚀");
+      } finally {
+        interning.close();
+      }
+    });
+
+    it("can decode datetimes natively", () => {
+      const sql = `select date from ${TABLE} where nr = 4`;
+      const epoch = Date.UTC(2021, 1, 20);
+      const dates = new Transbase({ ...config, dateCast: "date" });
+      const epochs = new Transbase({ ...config, dateCast: "epoch" });
+      try {
+        assert.deepEqual(dates.query(sql).next().date, new Date(epoch));
+        assert.equal(epochs.query(sql).next().date, epoch);
+        const batch = epochs.query(sql).fetchColumns();
+        assert.deepEqual(batch.columns[0].values, new Float64Array([epoch]));
+        assert.equal(client.query(sql).next().date, "2021-02-20 00:00:00.000");
+      } finally {
+        dates.close();
+        epochs.close();
+      }
+    });
   });
 
   describe("ResultSet", () => {
@@ -123,6 +165,88 @@ describe("Transbase.query", () => {
       const rs = client.query(`select * from ${TABLE} where nr <= 3`);
       assert.equal(rs.toArray().length, 3);
     });
+
+    it("toArray continues after rows read by next", () => {
+      const rs = client.query(`select nr from ${TABLE} where nr <= 3`);
+      assert.equal(rs.next().nr, 1);
+      assert.deepEqual(rs.toArray().map((it) => it.nr), [2, 3]);
+      assert.equal(rs.next(), undefined);
+      assert.ok(!rs.hasNext());
+    });
+
+    it("refuses low-level reads after next read rows ahead", () => {
+      const rs = client.query(`select nr from ${TABLE} where nr <= 3`);
+      assert.equal(rs.next().nr, 1);
+      assert.throws(() => rs.readValue("nr"), /read rows ahead/);
+      assert.throws(() => rs.fetch(), /read rows ahead/);
+    });
+
+    it("can fetch with a fixed or adaptive fetch size", () => {
+      const sql = `select nr from ${TABLE} order by nr`;
+      const all = client.query(sql).toArray();
+      const fixed = client.query(sql, [], { fetchSize: 2 });
+      assert.equal(fixed.next().nr, all[0].nr);
+      assert.deepEqual(fixed.toArray(), all.slice(1));
+      assert.throws(() => client.query(sql, [], { fetchSize: 0 }), RangeError);
+    });
+
+    it("can fetch lazy rows", () => {
+      const sql = `select * from ${TABLE} where nr <= 3`;
+      const rows = client.query(sql, [], { lazy: true }).toArray();
+      assert.equal(rows.length, 3);
+      assert.equal(rows[1].comment, "Lunch🚀");
+      assert.equal(rows[1].comment, rows[1].comment);
+      assert.deepEqual(
+        JSON.parse(JSON.stringify(rows)),
+        JSON.parse(JSON.stringify(client.query(sql).toArray()))
+      );
+    });
+
+    it("reads the first of equally named columns of lazy rows", () => {
+      const sql = `select a.nr, b.nr from ${TABLE} a, ${TABLE} b where a.nr = 1 and b.nr = 2`;
+      const [row] = client.query(sql, [], { lazy: true }).toArray();
+      assert.equal(row.nr, 1);
+      assert.deepEqual(JSON.parse(JSON.stringify(row)), { nr: 1 });
+    });
+
+    it("describes columns once per cached statement", () => {
+      const sql = `select nr, comment from ${TABLE} where nr = ?`;
+      const first = client.query(sql, [1]);
+      assert.deepEqual(
+        first.getColumns().map(({ col, name, typeName }) => ({
+          col,
+          name,
+          typeName,
+        })),
+        [
+          { col: 1, name: "nr", typeName: "INTEGER" },
+          { col: 2, name: "comment", typeName: "VARCHAR" },
+        ]
+      );
+      assert.equal(first.getColumn("comment").col, 2);
+      const second = client.query(sql, [2]);
+      assert.equal(second.getColumns(), first.getColumns());
+      assert.equal(second.next().comment, "Lunch🚀");
+    });
+  });
+
+  describe("columnar fetch", () => {
+    it("can fetch columns as typed arrays", () => {
+      const rs = client.query(`select nr, amount, comment from ${TABLE}`);
+      const { length, columns } = rs.fetchColumns();
+      const [nr, amount, comment] = columns;
+      assert.equal(length, 5);
+      assert.ok(nr.values instanceof Int32Array);
+      assert.ok(amount.values instanceof Float64Array);
+      assert.deepEqual(Array.from(nr.values), [1, 2, 3, 4, 5]);
+      assert.equal(amount.values[0], 100);
+      assert.equal(
+        comment.data.toString("utf8", comment.offsets[1], comment.offsets[2]),
+        "Lunch🚀"
+      );
+      assert.equal(comment.nulls[0], 0b10000); // row 5 IS NULL
+      assert.equal(rs.fetchColumns().length, 0);
+    });
   });
 
   describe("parametrized queries", () => {
@@ -173,6 +297,150 @@ describe("Transbase.query", () => {
     });
   });
 
+  describe("stats", () => {
+    it("records latencies and counters if enabled", () => {
+      const measured = new Transbase({ ...config, stats: true });
+      try {
+        measured.query(`select * from ${TABLE}`).toArray();
+        const stats = measured.getStats();
+        assert.equal(stats.queries, 1);
+        assert.equal(stats.rows, 5);
+        assert.equal(stats.execute.count, 1);
+        assert.equal(stats.firstRow.count, 1);
+        assert.equal(stats.fetch.count, 1);
+        assert.ok(stats.fetch.max >= stats.fetch.p50);
+        assert.throws(() => measured.query("select * from not_existing_table"));
+        assert.equal(Object.keys(measured.getStats().errors).length, 1);
+        measured.resetStats();
+        assert.equal(measured.getStats().queries, 0);
+      } finally {
+        measured.close();
+      }
+    });
+
+    it("records nothing by default", () => {
+      client.query(`select * from ${TABLE}`).toArray();
+      assert.equal(client.getStats().queries, 0);
+    });
+
+    it("publishes queries to the diagnostics channel", () => {
+      const diagnostics_channel = require("diagnostics_channel");
+      const events = [];
+      const onQuery = (event) => events.push(event);
+      diagnostics_channel.subscribe("transbase:query", onQuery);
+      try {
+        client.query(`select * from ${TABLE} where nr = ?`, [1]);
+      } finally {
+        diagnostics_channel.unsubscribe("transbase:query", onQuery);
+      }
+      assert.equal(events.length, 1);
+      assert.deepEqual(events[0].parameters, [1]);
+      assert.ok(events[0].duration >= 0);
+    });
+  });
+
+  describe("prepared statements", () => {
+    it("reuses cached statements for parametrized queries", () => {
+      const sql = `select nr from ${TABLE} where nr = ?`;
+      client.query(sql, [1]).toArray();
+      const { hits } = client.getStatementCacheStats();
+      assert.equal(client.query(sql, [2]).next().nr, 2);
+      assert.equal(client.getStatementCacheStats().hits, hits + 1);
+    });
+
+    it("can execute an explicitly prepared statement repeatedly", () => {
+      const statement = client.prepare(
+        `select nr from ${TABLE} where nr = :nr`
+      );
+      assert.equal(statement.query({ nr: 1 }).next().nr, 1);
+      assert.equal(statement.query({ nr: 3 }).next().nr, 3);
+    });
+
+    it("reuses the bind plan with values of different length", () => {
+      const statement = client.prepare(
+        `select nr from ${TABLE} where comment = ?`
+      );
+      assert.equal(statement.query(["Drink"]).toArray().length, 1);
+      assert.equal(statement.query(["Lunch🚀"]).next().nr, 2);
+      assert.equal(statement.query(["Drink"]).toArray().length, 1);
+    });
+
+    it("evicts least recently used statements", () => {
+      const small = new Transbase({ ...config, statementCacheSize: 1 });
+      try {
+        small.query(`select nr from ${TABLE} where nr = ?`, [1]);
+        small.query(`select amount from ${TABLE} where nr = ?`, [1]);
+        const stats = small.getStatementCacheStats();
+        assert.equal(stats.size, 1);
+        assert.equal(stats.evictions, 1);
+      } finally {
+        small.close();
+      }
+    });
+  });
+
+  describe("result cache", () => {
+    let cached;
+    const sql = `select nr, comment from ${TABLE} where nr <= ? order by nr`;
+    beforeEach(() => {
+      cached = new Transbase({ ...config, resultCache: { ttl: 60000 } });
+    });
+    afterEach(() => cached.close());
+
+    it("serves equal queries from the cache", async () => {
+      const rows = cached.query(sql, [3], { cache: true }).toArray();
+      assert.equal(rows.length, 3);
+      assert.deepEqual(cached.query(sql, [3], { cache: true }).toArray(), rows);
+      const resultSet = await cached.queryAsync(sql, [3], { cache: true });
+      assert.deepEqual(await resultSet.toArrayAsync(), rows);
+      assert.equal(cached.query(sql, [2], { cache: true }).toArray().length, 2);
+      const stats = cached.getResultCacheStats();
+      assert.equal(stats.hits, 2);
+      assert.equal(stats.misses, 2);
+      assert.equal(stats.size, 2);
+      assert.ok(stats.bytes > 0);
+    });
+
+    it("serves cached rows with next", () => {
+      cached.query(sql, [3], { cache: true }).toArray();
+      const resultSet = cached.query(sql, [3], { cache: true });
+      assert.equal(resultSet.next().nr, 1);
+      assert.equal(resultSet.next().nr, 2);
+      assert.equal(resultSet.next().nr, 3);
+      assert.equal(resultSet.next(), undefined);
+      assert.equal(resultSet.hasNext(), false);
+    });
+
+    it("invalidates results of tables written by the client", () => {
+      cached.query(sql, [99999], { cache: true }).toArray();
+      cached.query("select 1 from systable first(1)", undefined, {
+        cache: true,
+      });
+      cached.query(`update ${TABLE} set comment = comment where nr = 1`);
+      const stats = cached.getResultCacheStats();
+      assert.equal(stats.invalidations, 1);
+      assert.equal(stats.size, 1);
+      cached.clearResultCache();
+      assert.equal(cached.getResultCacheStats().size, 0);
+    });
+
+    it("does not cache results with more than maxRows rows", () => {
+      const small = new Transbase({ ...config, resultCache: { maxRows: 2 } });
+      try {
+        const rows = small.query(sql, [4], { cache: true }).toArray();
+        assert.deepEqual(rows.map((row) => row.nr), [1, 2, 3, 4]);
+        assert.equal(small.getResultCacheStats().size, 0);
+      } finally {
+        small.close();
+      }
+    });
+
+    it("does not cache without the cache option", () => {
+      cached.query(sql, [3]).toArray();
+      assert.equal(cached.getResultCacheStats().misses, 0);
+    });
+  });
+
   describe(`insert/update/delete`, () => {
     before(() => client.query(`delete from ${TABLE} where nr >= 9998`));
     it("returns number of added rows", () => {
@@ -197,6 +465,116 @@ describe("Transbase.query", () => {
     it("returns number of deleted rows", () => {
       assert.equal(client.query(`delete from ${TABLE} where nr >= 9998`), 2);
     });
+
+    it("can insert rows in batches", () => {
+      assert.deepEqual(
+        client.executeBatch(
+          `insert into ${TABLE} (nr, amount, comment) values (?, ?, ?)`,
+          [
+            [9998, 1, "BATCH"],
+            [9999, 2.5, null],
+          ],
+          { chunkSize: 1 }
+        ),
+        [1, 1]
+      );
+      assert.equal(client.query(`delete from ${TABLE} where nr >= 9998`), 2);
+    });
+
+    it("can insert rows with named parameters asynchronously", async () => {
+      assert.deepEqual(
+        await client.executeBatchAsync(
+          `insert into ${TABLE} (nr, amount) values (:nr, :amount)`,
+          [
+            { nr: 9998, amount: 1 },
+            { nr: 9999, amount: 2 },
+          ]
+        ),
+        [1, 1]
+      );
+      assert.equal(client.query(`delete from ${TABLE} where nr >= 9998`), 2);
+    });
+
+    it("reports the failing row and rolls back its chunk", () => {
+      assert.throws(
+        () =>
+          client.executeBatch(
+            `insert into ${TABLE} (nr, amount) values (?, ?)`,
+            [
+              [9998, 1],
+              [9998, 1],
+            ],
+            { chunkSize: 2 }
+          ),
+        (e) => e.index === 1
+      );
+      assert.equal(client.query(`delete from ${TABLE} where nr >= 9998`), 0);
+    });
+
+    it("rejects rows unlike the first row", () => {
+      const sql = `insert into ${TABLE} (nr, amount) values (?, ?)`;
+      assert.throws(
+        () => client.executeBatch(sql, [[9998, 1], [9999]]),
+        /row 1 has 1 parameters but the first row has 2/
+      );
+      assert.throws(
+        () => client.executeBatch(sql, [[9998, 1], { nr: 9999, amount: 1 }]),
+        /row 1 is an object/
+      );
+      assert.equal(client.query(`delete from ${TABLE} where nr >= 9998`), 0);
+    });
+
+    it("executes scripts in one transaction", () => {
+      const results = client.executeScript(`
+        insert into ${TABLE} (nr, amount, comment) values (9998, 1, 'a;b');
+        -- a comment; not a statement
+        update ${TABLE} set amount = 2 where nr >= 9998; /* ; */
+        select * from ${TABLE};
+      `);
+      assert.deepEqual(
+        results.map(({ state, type, records }) => [state, type, records]),
+        [
+          ["ok", "UPDATE", 1],
+          ["ok", "UPDATE", 1],
+          ["ok", "SELECT", 0],
+        ]
+      );
+      results.forEach((result) => assert.ok(result.ms >= 0));
+      assert.equal(client.query(`delete from ${TABLE} where nr >= 9998`), 1);
+    });
+
+    it("rolls back a script on the first failure", async () => {
+      await assert.rejects(
+        client.executeScriptAsync([
+          `insert into ${TABLE} (nr, amount) values (9998, 1)`,
+          `insert into ${TABLE} (nr, amount) values (9998, 1)`,
+          `insert into ${TABLE} (nr, amount) values (9999, 1)`,
+        ]),
+        (e) =>
+          e.index === 1 &&
+          e.results.length === 2 &&
+          e.results[0].state === "rolledBack" &&
+          e.results[1].state === "failed"
+      );
+      assert.equal(client.query(`delete from ${TABLE} where nr >= 9998`), 0);
+    });
+
+    it("can go on after failures", () => {
+      const results = client.executeScript(
+        [
+          `insert into ${TABLE} (nr, amount) values (9998, 1)`,
+          `insert into ${TABLE} (nr, amount) values (9998, 1)`,
+          `insert into ${TABLE} (nr, amount) values (9999, 1)`,
+        ],
+        { transactional: false, stopOnError: false }
+      );
+      assert.deepEqual(
+        results.map((result) => result.state),
+        ["ok", "failed", "ok"]
+      );
+      assert.ok(results[1].error);
+      assert.equal(client.query(`delete from ${TABLE} where nr >= 9998`), 2);
+    });
   });
 
   describe("blobs clobs and binaries", () => {
@@ -233,6 +611,15 @@ describe("Transbase.query", () => {
       console.log(a.digest("hex"));
     });
 
+    it("fetches rows with lobs eagerly although lazy", () => {
+      const sql = `select id, image from ${BLOB_TABLE} where id = 1`;
+      const rs = client.query(sql, [], { lazy: true });
+      const row = rs.next();
+      assert.equal(row.id, 1);
+      assert.equal(rs.next(), undefined);
+      assert.ok(row.image.equals(require("fs").readFileSync("./README.md")));
+    });
+
     it("can read blob as buffer", () => {
       const blob = require("fs").readFileSync("./README.md");
       client.query(`insert into ${BLOB_TABLE} values (11, ?, null, null);`, [
@@ -252,6 +639,35 @@ describe("Transbase.query", () => {
       );
     });
 
+    it("can read clob chunks into a reused buffer", async () => {
+      const clob = require("fs").readFileSync("./README.md").toString();
+      client.query(`insert into ${BLOB_TABLE} values (12, null, ?, null);`, [
+        clob,
+      ]);
+      const rs = client.query(`select text from ${BLOB_TABLE} where id = 12`);
+      rs.fetch();
+      let text = "";
+      for await (const chunk of rs.readValueChunks("text", {
+        chunkSize: 1024,
+      })) {
+        text += chunk;
+      }
+      assert.equal(clob, text);
+    });
+
+    it("can upload a blob from a stream", async () => {
+      const { Readable } = require("stream");
+      const blob = require("fs").readFileSync("./README.md");
+      await client.queryAsync(
+        `insert into ${BLOB_TABLE} values (13, ?, null, null);`,
+        [Readable.from([blob.subarray(0, 100), blob.subarray(100)])]
+      );
+      const { image } = client
+        .query(`select image from ${BLOB_TABLE} where id = 13`)
+        .next();
+      assert.ok(blob.equals(image));
+    });
+
     it("can insert and select clob values as string", () => {
       const clob = require("fs").readFileSync("./README.md").toString();
       client.query(`insert into ${BLOB_TABLE} values (2, null, ?, null);`, [
@@ -349,6 +765,25 @@ describe("Transbase.query", () => {
       });
     });
 
+    it("can select datetimes and timespans as epoch milliseconds", () => {
+      const epochs = new Transbase({ ...config, dateCast: "epoch" });
+      try {
+        const row = epochs
+          .query(`select p, q, r, s, t, u from LEDGER_${UID}`)
+          .next();
+        assert.deepEqual(row, {
+          p: "2002-12",
+          q: Date.UTC(2002, 11, 24),
+          r: ((17 * 60 + 35) * 60 + 10) * 1000,
+          s: Date.UTC(2002, 11, 24, 17, 35, 10, 250),
+          t: "2-06",
+          u: ((2 * 60 + 12) * 60 + 35) * 1000,
+        });
+      } finally {
+        epochs.close();
+      }
+    });
+
     const expected = {
       a: "120",
       b: "32000",
@@ -439,6 +874,19 @@ describe("Transbase.query", () => {
         "e84b812c3d611dad03dbcf6d6954a2d618b1f11b748690fcf27b40d869acf68f"
       );
     });
+
+    it("can compute hashes of records natively", async () => {
+      const rs = client.query(`select * from LEDGER_${UID}`);
+      const hashes = rs.hashLedgerRecords();
+      assert.deepEqual(
+        hashes.map((hash) => hash.toString("hex")),
+        ["e84b812c3d611dad03dbcf6d6954a2d618b1f11b748690fcf27b40d869acf68f"]
+      );
+      assert.deepEqual(rs.hashLedgerRecords(), []);
+
+      const rsAsync = await client.queryAsync(`select * from LEDGER_${UID}`);
+      assert.deepEqual(await rsAsync.hashLedgerRecordsAsync(), hashes);
+    });
   });
 
   it("can create and call a persisted stored method", () => {
@@ -458,6 +906,293 @@ describe("Transbase.query", () => {
     assert.equal(1, result.toArray().length);
   });
 
+  describe("async", () => {
+    it("can connect asynchronously", async () => {
+      const asyncClient = await Transbase.connect(config);
+      try {
+        assert.ok(asyncClient.getVersionInfo().server);
+      } finally {
+        asyncClient.close();
+      }
+    });
+
+    it("can query and fetch asynchronously", async () => {
+      const rs = await client.queryAsync(
+        `select * from ${TABLE} where nr <= ?`,
+        [3]
+      );
+      assert.equal((await rs.toArrayAsync()).length, 3);
+    });
+
+    it("returns number of affected rows", async () => {
+      assert.equal(
+        await client.queryAsync(
+          `update ${TABLE} set amount = amount where nr = 1`
+        ),
+        1
+      );
+    });
+
+    it("rejects with tci errors", async () => {
+      await assert.rejects(
+        client.queryAsync("select * from not_existing_table")
+      );
+    });
+
+    it("rejects synchronous calls while busy", async () => {
+      const pending = client.queryAsync(`select * from ${TABLE}`);
+      assert.throws(() => client.query(`select * from ${TABLE}`), /busy/);
+      await pending;
+    });
+  });
+
+  describe("exportQuery", () => {
+    const fs = require("fs");
+    const path = require("path");
+    const file = path.join(require("os").tmpdir(), `export_${UID}`);
+    after(() => fs.rmSync(file, { force: true }));
+
+    it("can export ndjson", async () => {
+      const sql = `select nr, amount, comment from ${TABLE}`;
+      const result = await client.exportQuery(sql, undefined, {
+        format: "ndjson",
+        path: file,
+      });
+      const rows = client.query(sql).toArray();
+      const lines = fs.readFileSync(file, "utf8").trim().split("\n");
+      assert.deepEqual(result, {
+        rows: rows.length,
+        bytes: fs.statSync(file).size,
+      });
+      assert.deepEqual(lines.map((line) => JSON.parse(line)), rows);
+    });
+
+    it("can export csv with parameters", async () => {
+      await client.exportQuery(
+        `select nr, comment from ${TABLE} where nr <= ?`,
+        [2],
+        { path: file, delimiter: ";" }
+      );
+      assert.equal(
+        fs.readFileSync(file, "utf8"),
+        "nr;comment\n1;Withdrawal\n2;Lunch🚀\n"
+      );
+    });
+
+    it("can export an arrow stream", async () => {
+      const result = await client.exportQuery(`select * from ${TABLE}`, [], {
+        format: "arrow",
+        path: file,
+      });
+      const data = fs.readFileSync(file);
+      const rows = client.query(`select * from ${TABLE}`).toArray();
+      assert.equal(result.rows, rows.length);
+      assert.equal(data.readUInt32LE(0), 0xffffffff); // continuation marker of the schema message
+      assert.deepEqual([...data.subarray(-8)], [255, 255, 255, 255, 0, 0, 0, 0]);
+    });
+  });
+
+  describe("importFile", () => {
+    const fs = require("fs");
+    const path = require("path");
+    const file = path.join(require("os").tmpdir(), `import_${UID}`);
+    const IMPORT_TABLE = `import_${UID}`;
+
+    before(() => {
+      client.query(`create table ${IMPORT_TABLE}
+        (nr integer, amount double, comment varchar(*), flag bool)`);
+    });
+    after(() => {
+      fs.rmSync(file, { force: true });
+      client.query(`drop table ${IMPORT_TABLE}`);
+    });
+    beforeEach(() => client.query(`delete from ${IMPORT_TABLE}`));
+
+    it("can import csv and reports rejected lines", async () => {
+      fs.writeFileSync(
+        file,
+        'nr,amount,comment,flag\n1,2.5,"a,""b""",true\nx,1,y,true\n2,,,0\n'
+      );
+      const result = await client.importFile(IMPORT_TABLE, file);
+      assert.equal(result.rows, 2);
+      assert.equal(result.rejected, 1);
+      assert.equal(result.rejects[0].line, 3);
+      assert.deepEqual(
+        client.query(`select * from ${IMPORT_TABLE} order by nr`).toArray(),
+        [
+          { nr: 1, amount: 2.5, comment: 'a,"b"', flag: true },
+          { nr: 2, amount: null, comment: null, flag: false },
+        ]
+      );
+    });
+
+    it("can import ndjson in batches", async () => {
+      const lines = Array.from({ length: 25 }, (_, i) =>
+        JSON.stringify({ nr: i, comment: `line ${i}` })
+      );
+      fs.writeFileSync(file, lines.join("\n"));
+      const progress = [];
+      const result = await client.importFile(IMPORT_TABLE, file, {
+        format: "ndjson",
+        columns: ["nr", "comment"],
+        batchSize: 10,
+        onProgress: ({ rows }) => progress.push(rows),
+      });
+      assert.equal(result.rows, 25);
+      assert.equal(
+        client.query(`select count(*) as n from ${IMPORT_TABLE}`).next().n,
+        25
+      );
+      await new Promise((resolve) => setImmediate(resolve));
+      assert.deepEqual(progress, [10, 20]);
+    });
+
+    it("fails if too many lines are rejected", async () => {
+      fs.writeFileSync(file, "nr\nx\ny\n");
+      await assert.rejects(
+        client.importFile(IMPORT_TABLE, file, { maxRejects: 1 }),
+        /too many rejected lines/
+      );
+    });
+  });
+
+  describe("cursor", () => {
+    it("keeps its result set open while the client runs other queries", () => {
+      const cursor = client.openCursor();
+      try {
+        const rs = cursor.query(`select nr from ${TABLE} where nr <= ?`, [3]);
+        const lookup = `select amount from ${TABLE} where nr = ?`;
+        let count = 0;
+        for (let row; (row = rs.next()); count++) {
+          assert.equal(client.query(lookup, [row.nr]).toArray().length, 1);
+        }
+        assert.equal(count, 3);
+      } finally {
+        cursor.close();
+      }
+    });
+
+    it("can query asynchronously", async () => {
+      const cursor = client.openCursor();
+      try {
+        const rs = await cursor.queryAsync(`select * from ${TABLE}`);
+        const rows = client.query(`select * from ${TABLE}`).toArray();
+        assert.equal((await rs.toArrayAsync()).length, rows.length);
+      } finally {
+        cursor.close();
+      }
+    });
+
+    it("can not be used after close", () => {
+      const cursor = client.openCursor();
+      cursor.close();
+      assert.throws(() => cursor.query(`select * from ${TABLE}`), /closed/);
+    });
+  });
+
+  describe("stream", () => {
+    it("can stream rows", async () => {
+      const rows = [];
+      for await (const row of client.stream(
+        `select nr from ${TABLE} order by nr`,
+        undefined,
+        { batchSize: 2 }
+      )) {
+        rows.push(row.nr);
+      }
+      assert.deepEqual(rows, [1, 2, 3, 4, 5]);
+    });
+
+    it("can stream columnar batches", async () => {
+      let length = 0;
+      for await (const batch of client.stream(
+        `select nr from ${TABLE}`,
+        undefined,
+        { columnar: true, batchSize: 2 }
+      )) {
+        assert.ok(batch.columns[0].values instanceof Int32Array);
+        length += batch.length;
+      }
+      assert.equal(length, 5);
+    });
+
+    it("emits tci errors", async () => {
+      await assert.rejects(async () => {
+        for await (const _ of client.stream("select * from not_existing_table"));
+      });
+    });
+  });
+
+  describe("timeouts and cancellation", () => {
+    // a cross join large enough to run well beyond the timeouts
+    const SLOW = "select a.cname from syscolumn a, syscolumn b, syscolumn c";
+
+    it("cancels a query after its timeout", () => {
+      assert.throws(
+        () => client.query(SLOW, undefined, { timeout: 50 }).toArray(),
+        (e) => e instanceof TimeoutError && e.timeout === 50
+      );
+      assert.equal(client.query(`select nr from ${TABLE}`).toArray().length, 5);
+    });
+
+    it("cancels an async query after its timeout", async () => {
+      await assert.rejects(
+        client
+          .queryAsync(SLOW, [], { timeout: 50 })
+          .then((resultSet) => resultSet.toArrayAsync()),
+        TimeoutError
+      );
+      assert.equal(client.query(`select nr from ${TABLE}`).toArray().length, 5);
+    });
+
+    it("cancels a query on abort", async () => {
+      const controller = new AbortController();
+      const rows = client
+        .queryAsync(SLOW, undefined, { signal: controller.signal })
+        .then((resultSet) => resultSet.toArrayAsync());
+      setTimeout(() => controller.abort(), 50);
+      await assert.rejects(rows, AbortError);
+      assert.equal(client.query(`select nr from ${TABLE}`).toArray().length, 5);
+    });
+
+    it("does not run a query aborted already", () => {
+      const controller = new AbortController();
+      controller.abort();
+      assert.throws(
+        () => client.query(SLOW, undefined, { signal: controller.signal }),
+        AbortError
+      );
+    });
+
+    it("does not run a batch or script aborted already", async () => {
+      const controller = new AbortController();
+      controller.abort();
+      const options = { signal: controller.signal };
+      const sql = `insert into ${TABLE} (amount) values (?)`;
+      await assert.rejects(
+        client.executeBatchAsync(sql, [[1]], options),
+        AbortError
+      );
+      assert.throws(
+        () => client.executeScript([`delete from ${TABLE}`], options),
+        AbortError
+      );
+      assert.equal(client.query(`select nr from ${TABLE}`).toArray().length, 5);
+    });
+
+    it("destroys a stream on abort", async () => {
+      const controller = new AbortController();
+      const stream = client.stream(SLOW, undefined, {
+        signal: controller.signal,
+      });
+      setTimeout(() => controller.abort(), 50);
+      await assert.rejects(async () => {
+        for await (const _ of stream);
+      }, AbortError);
+      assert.equal(client.query(`select nr from ${TABLE}`).toArray().length, 5);
+    });
+  });
+
   describe("transaction", () => {
     it("can rollback transaction", () => {
       const client = new Transbase(config);
@@ -1,7 +1,65 @@
+import { Readable } from "stream";
+
 type Value = string | number | boolean | Buffer | null | undefined;
-type PositionedParamter = Value[];
-type NamedParameter = { [parameterName: string]: Value };
+/** async iterables (e.g. a Readable of a file) are uploaded chunk by chunk, queryAsync only */
+type ParamValue = Value | AsyncIterable<Buffer | string>;
+type PositionedParamter = ParamValue[];
+type NamedParameter = { [parameterName: string]: ParamValue };
 type Params = PositionedParamter | NamedParameter;
+type QueryOptions = {
+  typeCast?: boolean;
+  /**
+   * rows hold the fetched native values and convert a column on first access.
+   * Ignored for results with BLOB or CLOB columns, their rows are fetched eagerly with all lobs read.
+   */
+  lazy?: boolean;
+  /** rows fetched per native call, overrides the connection setting @see TransbaseConfig.fetchSize */
+  fetchSize?: FetchSize;
+  /**
+   * serve a select from the result cache of the client, or cache its rows @see TransbaseConfig.resultCache.
+   * Rows of a cached result are read with next, toArray and their async variants only.
+   */
+  cache?: boolean;
+} & CancelOptions;
+type CancelOptions = {
+  /**
+   * milliseconds after which the execution and the reading of its result set are cancelled
+   * with a TimeoutError, the running native call is cancelled on the server
+   */
+  timeout?: number;
+  /** cancel the running native call on abort, it fails with an AbortError */
+  signal?: AbortSignal;
+};
+type FetchSize = number | "adaptive";
+/**
+ * one column of a columnar batch, null values are flagged in the packed nulls bitmap
+ * (bit i % 8 of byte i / 8 is set if row i IS NULL)
+ */
+type ColumnData = {
+  name: string;
+  /** sql column type code @see SqlType */
+  type: number;
+  nulls: Uint8Array;
+  /** DOUBLE/NUMERIC/FLOAT, INTEGER/SMALLINT/TINYINT, BIGINT and BOOL columns */
+  values?: Float64Array | Int32Array | BigInt64Array | Uint8Array;
+  /** string and binary columns: value i is data[offsets[i]..offsets[i+1]] */
+  offsets?: Uint32Array;
+  data?: Buffer;
+};
+type StreamOptions = {
+  /** number of buffered rows (default 1000), or batches if columnar (default 2) */
+  highWaterMark?: number;
+  /** number of rows fetched with one native call (default highWaterMark, 1000 if columnar) */
+  batchSize?: number;
+  /** emit ColumnBatch chunks instead of row objects */
+  columnar?: boolean;
+  typeCast?: boolean;
+} & CancelOptions;
+type ColumnBatch = {
+  /** number of rows in this batch */
+  length: number;
+  columns: ColumnData[];
+};
 type ColInfo = {
   /** column index starting from 1 */
   col: number;
@@ -11,6 +69,12 @@ type ColInfo = {
   type: number;
   /** readable sql column type name @see SqlTypeName */
   typeName: SqlTypeName;
+  /** numeric precision or character length, if reported by the tci library */
+  precision?: number;
+  /** numeric scale, if reported by the tci library */
+  scale?: number;
+  /** false for NOT NULL columns, if reported by the tci library */
+  nullable?: boolean;
 };
 
 export interface TransbaseConfig {
@@ -27,6 +91,267 @@ export interface TransbaseConfig {
    * @default true
    */
   typeCast?: boolean;
+  /**
+   * Maximum number of prepared statements kept per connection (least recently used are evicted).
+   * Set to 0 to prepare parametrized queries on every call.
+   * @default 16
+   */
+  statementCacheSize?: number;
+  /**
+   * Record latency histograms and counters, @see Transbase.getStats
+   * @default false
+   */
+  stats?: boolean;
+  /**
+   * Reuse the strings of repeated short column values (e.g. status codes) within a fetched batch of rows.
+   * Saves memory for low-cardinality columns, columns with many distinct values are not affected.
+   * @default false
+   */
+  internStrings?: boolean;
+  /**
+   * Determines how datetime and timespan values are converted if typeCast is enabled.
+   * options:
+   * - "string": as formatted by the database (default)
+   * - "date": datetimes with a year as Date (interpreted as UTC),
+   *   times of the day and day-time timespans as milliseconds
+   * - "epoch": datetimes with a year as epoch milliseconds (interpreted as UTC),
+   *   times of the day and day-time timespans as milliseconds
+   * Datetimes without year and year-month timespans are always strings.
+   * In columnar mode decoded columns are Float64Arrays of milliseconds.
+   * @default "string"
+   */
+  dateCast?: "string" | "date" | "epoch";
+  /**
+   * Number of rows next() and toArray() fetch and convert with a single native call.
+   * "adaptive" starts with a small batch for point queries and doubles it for every further batch of a long scan.
+   * @default "adaptive"
+   */
+  fetchSize?: FetchSize;
+  /** limits of the result cache used by queries with the cache option */
+  resultCache?: ResultCacheConfig;
+}
+
+export interface ResultCacheConfig {
+  /** native bytes of all cached results, least recently used are evicted @default 16 MiB */
+  maxBytes?: number;
+  /** milliseconds a result is served from the cache @default 1000 */
+  ttl?: number;
+  /** results with more rows are not cached @default 10000 */
+  maxRows?: number;
+}
+
+/** a timeout or abort cancels all rows, rows of the current chunk are rolled back if transactional */
+export interface BatchOptions extends CancelOptions {
+  /** number of rows committed per transaction @default 1000 */
+  chunkSize?: number;
+  /** run every chunk in its own transaction, otherwise every row is auto-committed @default true */
+  transactional?: boolean;
+}
+
+/** a timeout or abort stops the script, also without stopOnError */
+export interface ScriptOptions extends CancelOptions {
+  /** run all statements in one transaction, otherwise every statement is auto-committed @default true */
+  transactional?: boolean;
+  /** throw the first failure and roll back the transaction, otherwise report it and go on @default true */
+  stopOnError?: boolean;
+}
+
+export interface ScriptResult {
+  /** rolledBack: executed, but its transaction was rolled back by a later failure */
+  state: "ok" | "failed" | "rolledBack";
+  /** query type, unset if the statement failed */
+  type?: "SELECT" | "UPDATE" | "SCHEMA" | number;
+  /** affected records of an update */
+  records: number;
+  /** execution time in milliseconds */
+  ms: number;
+  error?: string;
+}
+
+export interface ExportOptions extends CancelOptions {
+  /** csv, ndjson (a json object per line) or arrow (arrow ipc stream) @default "csv" */
+  format?: "csv" | "ndjson" | "arrow";
+  /** file to write, created or truncated */
+  path?: string;
+  /** open file descriptor to write instead of path, it is not closed */
+  fd?: number;
+  /** csv header line of column names @default true */
+  header?: boolean;
+  /** csv field delimiter @default "," */
+  delimiter?: string;
+  /** rows fetched per native batch and per arrow record batch @default 8192 */
+  batchSize?: number;
+  typeCast?: boolean;
+}
+
+/** a timeout or abort cancels the whole import, the rows of the current batch are rolled back if transactional */
+export interface ImportOptions extends CancelOptions {
+  /** csv or ndjson (a flat json object per line) @default "csv" */
+  format?: "csv" | "ndjson";
+  /** target columns in field order, the csv header or all columns of the table by default */
+  columns?: string[];
+  /** the first csv line names the columns @default true */
+  header?: boolean;
+  /** csv field delimiter @default "," */
+  delimiter?: string;
+  /** rows committed per transaction @default 10000 */
+  batchSize?: number;
+  /** commit every batch in its own transaction, otherwise every row is auto-committed @default true */
+  transactional?: boolean;
+  /** the import fails if more lines are rejected @default Infinity */
+  maxRejects?: number;
+  /** called after every batch */
+  onProgress?: (progress: ImportProgress) => void;
+}
+
+export interface ImportProgress {
+  /** rows inserted */
+  rows: number;
+  /** lines that could not be parsed or converted */
+  rejected: number;
+  /** bytes of the file read */
+  bytes: number;
+}
+
+export interface ImportResult extends ImportProgress {
+  /** line number and error of the first 100 rejected lines */
+  rejects: { line: number; error: string }[];
+}
+
+export interface TransbasePoolConfig extends TransbaseConfig {
+  /** number of connections opened up front and kept open @default 4 */
+  size?: number;
+  /** maximum number of connections, additional ones are opened on demand @default size */
+  max?: number;
+  /** milliseconds to wait for an idle connection before acquire fails @default 30000 */
+  acquireTimeout?: number;
+  /** maximum number of queued acquire calls, further calls fail immediately @default Infinity */
+  maxWaiters?: number;
+  /** milliseconds after which idle connections above size are closed @default 60000 */
+  idleTimeout?: number;
+}
+
+export interface SharedPoolConfig {
+  url: string;
+  user: string;
+  password: string;
+  /** maximum number of sessions borrowed at once @default 4 */
+  max?: number;
+}
+
+export interface SharedPoolStats {
+  max: number;
+  borrowed: number;
+  idle: number;
+}
+
+export interface BorrowConfig extends Partial<TransbaseConfig> {
+  /** milliseconds to wait for a session while all are borrowed @default 30000 */
+  acquireTimeout?: number;
+}
+
+export interface StatementCacheStats {
+  size: number;
+  capacity: number;
+  hits: number;
+  misses: number;
+  evictions: number;
+}
+
+export interface ResultCacheStats {
+  size: number;
+  /** native bytes of the cached results */
+  bytes: number;
+  maxBytes: number;
+  hits: number;
+  misses: number;
+  evictions: number;
+  expirations: number;
+  /** results dropped by writes of the client */
+  invalidations: number;
+}
+
+/** latency summary in milliseconds */
+export interface LatencyStats {
+  count: number;
+  min: number;
+  max: number;
+  mean: number;
+  p50: number;
+  p90: number;
+  p99: number;
+  total: number;
+}
+
+export interface TransbaseStats {
+  enabled: boolean;
+  queries: number;
+  rows: number;
+  /** string and binary bytes converted */
+  bytes: number;
+  /** bytes of chunked value reads and uploads */
+  lobBytes: number;
+  prepare: LatencyStats;
+  execute: LatencyStats;
+  /** the first fetch of a query */
+  firstRow: LatencyStats;
+  /** all fetches of a query */
+  fetch: LatencyStats;
+  /** conversion of fetched values to js */
+  convert: LatencyStats;
+  /** number of errors by sqlcode */
+  errors: { [sqlcode: string]: number };
+}
+
+/** event published to the "transbase:query" diagnostics channel */
+export interface QueryEvent {
+  sql: string;
+  parameters?: Params;
+  /** milliseconds until the query is executed */
+  duration: number;
+  result?: unknown;
+  error?: Error;
+}
+
+/**********************************
+ * PREPARED STATEMENT
+ * a statement that is prepared once and executed with different parameters.
+ *********************************/
+export declare interface PreparedStatement {
+  readonly sql: string;
+  /** execute the statement with the given parameters, @see Transbase.query */
+  query<T = unknown>(
+    params?: Params,
+    options?: QueryOptions
+  ): T extends number ? number : ResultSet<T>;
+  /** execute the statement on a worker thread, @see Transbase.queryAsync */
+  queryAsync<T = unknown>(
+    params?: Params,
+    options?: QueryOptions
+  ): Promise<T extends number ? number : ResultSet<T>>;
+}
+
+/**********************************
+ * CURSOR
+ * runs queries on its own statement handles of the connection.
+ *********************************/
+export declare interface Cursor {
+  /** @see Transbase.query */
+  query<T = unknown>(
+    sql: string,
+    params?: Params,
+    options?: QueryOptions
+  ): T extends number ? number : ResultSet<T>;
+  /** @see Transbase.queryAsync */
+  queryAsync<T = unknown>(
+    sql: string,
+    params?: Params,
+    options?: QueryOptions
+  ): Promise<T extends number ? number : ResultSet<T>>;
+  /** @see Transbase.prepare */
+  prepare(sql: string): PreparedStatement;
+  /** close the result set and give the handles back to the connection */
+  close(): void;
 }
 
 /**********************************
@@ -34,12 +359,34 @@ export interface TransbaseConfig {
  * to fetch next rows sequentially or get all with toArray convenience
  *********************************/
 export declare interface ResultSet<T = unknown> {
-  /** fetch and get data of next row. Returns undefined if no data is found */
+  /**
+   * fetch and get data of next row. Returns undefined if no data is found.
+   * Rows are read ahead in batches, so do not mix next() with the low-level fetch/readValue api.
+   */
   next(): T;
+  /** like next, but the row is fetched on a worker thread without blocking the event loop */
+  nextAsync(): Promise<T | undefined>;
   /** false if there is no further row to fetch (NO_DATA_FOUND) */
   hasNext(): boolean;
   /** convenience to get all rows as object array */
   toArray(): T[];
+  /** convenience to get all rows as object array, fetching on a worker thread */
+  toArrayAsync(): Promise<T[]>;
+  /** fetch up to maxRows rows in columnar layout, length is 0 if no more data is found */
+  fetchColumns(maxRows?: number): ColumnBatch;
+  /** same as fetchColumns, but the rows are fetched on a worker thread */
+  fetchColumnsAsync(maxRows?: number): Promise<ColumnBatch>;
+  /**
+   * fetch up to maxRows rows and compute their sha-256 ledger record hashes natively,
+   * empty if no more data is found @see example/transbase-ledger.js
+   */
+  hashLedgerRecords(maxRows?: number): Buffer[];
+  /** same as hashLedgerRecords, but the rows are fetched and hashed on a worker thread */
+  hashLedgerRecordsAsync(maxRows?: number): Promise<Buffer[]>;
+  /** the sha-256 ledger record hash of the current row */
+  hashLedgerRecord(): Buffer;
+  /** fetch up to maxRows rows as object array on a worker thread, empty if no more data is found */
+  fetchRowsAsync(maxRows?: number): Promise<T[]>;
   //-----------------
   // low-level api
   //-----------------
@@ -47,6 +394,8 @@ export declare interface ResultSet<T = unknown> {
   getColumns(): ColInfo[];
   /** fetch the next record, use getValue or getValueAsString to retrieve data  */
   fetch(): boolean;
+  /** fetch the next record on a worker thread */
+  fetchAsync(): Promise<boolean>;
   /** read value by column number starting with 1 or column name (respects typeCast option). NOT IDEMPOTENT! */
   readValue<R = Value>(colNumberOrName: number | string): R;
   /** read value as string by column number starting with 1 or column name. NOT IDEMPOTENT!*/
@@ -56,6 +405,24 @@ export declare interface ResultSet<T = unknown> {
     colNumberOrName: number | string,
     size: number
   ): { data: Buffer; hasMore: boolean } | null;
+  /** read the next chunk of a value into the given buffer in place, bytes is null if the value IS NULL */
+  readValueInto(
+    colNumberOrName: number | string,
+    buffer: Buffer
+  ): { bytes: number | null; hasMore: boolean };
+  /**
+   * read a (large) value chunk by chunk on a worker thread into one reused buffer.
+   * A chunk is only valid until the next one is read.
+   */
+  readValueChunks(
+    colNumberOrName: number | string,
+    options?: { chunkSize?: number; buffer?: Buffer }
+  ): AsyncIterableIterator<Buffer>;
+  /** readable stream of a (large) value, every chunk is read into its own buffer on a worker thread */
+  createValueStream(
+    colNumberOrName: number | string,
+    options?: { chunkSize?: number }
+  ): Readable;
   /** return true if the given column number (starting with 1) or column name IS NULL */
   isNull(colNumberOrName: number | string): boolean;
 }
@@ -77,24 +444,131 @@ export declare class Transbase {
    **/
   constructor(config: TransbaseConfig);
 
+  /**
+   * create a new transbase database client, connecting and logging in on a worker thread
+   * @param config defining the database url connecting to, logging in with the given user and password
+   **/
+  static connect(config: TransbaseConfig): Promise<Transbase>;
+
+  /**
+   * create a new transbase database client on a session of a SharedPool instead of logging in, close gives it back
+   * @param name the name the pool is registered with
+   **/
+  static borrow(name: string, config?: BorrowConfig): Promise<Transbase>;
+
   /**
    * execute a query directly in auto-commit mode
    * @param sql the sql query to execute
    * @param params optional query parameters as an array of positional parameters or a key-value object for named parameters
-   * @param options optional query execute options (e.g. typeCast)
+   * @param options optional query execute options (e.g. typeCast or lazy)
    * @returns a ResultSet if the query has data to select or the number of affected records for insert,update statements
    **/
   query<T = unknown>(
     sql: string,
     params?: Params,
-    options?: { typeCast?: boolean }
+    options?: QueryOptions
   ): T extends number ? number : ResultSet<T>;
 
+  /**
+   * same as query, but the statement is prepared and executed on a worker thread without blocking the event loop.
+   * Only one async operation may run per client at a time.
+   **/
+  queryAsync<T = unknown>(
+    sql: string,
+    params?: Params,
+    options?: QueryOptions
+  ): Promise<T extends number ? number : ResultSet<T>>;
+
+  /**
+   * execute a statement once for every row of parameters in a single native call.
+   * The statement is prepared once and, if transactional, every chunk of rows is committed in its own transaction.
+   * @param rows array of positional parameter arrays or of named parameter objects, all with the names of the first
+   * @returns the number of affected records of every row.
+   * Throws the first failing row's error with its `index`, rows of a failed chunk are rolled back if transactional.
+   **/
+  executeBatch(sql: string, rows: Params[], options?: BatchOptions): number[];
+
+  /**
+   * stream the rows of a select query. Rows are fetched in batches on a worker thread,
+   * the next batch is fetched while the current one is consumed.
+   * @returns a Readable in object mode emitting rows, or ColumnBatch chunks if columnar
+   **/
+  stream(
+    sql: string,
+    params?: Params,
+    options?: StreamOptions
+  ): Readable;
+
+  /** same as executeBatch but the statements are executed on a worker thread */
+  executeBatchAsync(
+    sql: string,
+    rows: Params[],
+    options?: BatchOptions
+  ): Promise<number[]>;
+
+  /**
+   * execute a sequence of statements in a single native call, a script text is split on its semicolons.
+   * With stopOnError the first failure is thrown with its `index` and the `results` so far.
+   * @returns the result of every executed statement
+   **/
+  executeScript(
+    script: string | string[],
+    options?: ScriptOptions
+  ): ScriptResult[];
+
+  /** same as executeScript but the statements are executed on a worker thread */
+  executeScriptAsync(
+    script: string | string[],
+    options?: ScriptOptions
+  ): Promise<ScriptResult[]>;
+
+  /**
+   * insert the records of a csv or ndjson file into a table, read and inserted natively on a worker thread
+   * @returns a promise of the number of inserted rows and rejected lines
+   **/
+  importFile(
+    table: string,
+    path: string,
+    options?: ImportOptions
+  ): Promise<ImportResult>;
+
+  /**
+   * write all rows of a select query to a file, fetched and serialized natively on a worker thread
+   * @returns a promise of the number of rows and bytes written
+   **/
+  exportQuery(
+    sql: string,
+    params: Params | undefined,
+    options: ExportOptions
+  ): Promise<{ rows: number; bytes: number }>;
+
+  /** prepare a statement for repeated execution with different parameters */
+  prepare(sql: string): PreparedStatement;
+
+  /** open a cursor with its own result set that stays open while other queries run on this client */
+  openCursor(): Cursor;
+
+  /** hits, misses and evictions of the prepared statement cache */
+  getStatementCacheStats(): StatementCacheStats;
+
+  /** size, bytes, hits, misses, evictions, expirations and invalidations of the result cache */
+  getResultCacheStats(): ResultCacheStats;
+
+  /** drop all cached results, e.g. after another client changed the data */
+  clearResultCache(): void;
+
+  /** latency histograms and counters, only recorded with the stats config option */
+  getStats(): TransbaseStats;
+
+  resetStats(): void;
+
   /** close connection and free resources */
   close(): void;
 
   /** set typeCast conversion option @see TransbaseConfig.typeCast */
   setTypeCast(value: boolean): void;
+  /** set the number of rows fetched per native call @see TransbaseConfig.fetchSize */
+  setFetchSize(value?: FetchSize): void;
 
   getConnectionUrl(): string;
 
@@ -111,6 +585,91 @@ export declare class Transbase {
   getVersionInfo(): { client: string; server: string };
 }
 
+/**********************************
+ * TRANSBASE POOL
+ * a pool of connections sharing one tci environment. Queries are dispatched to idle
+ * connections and executed on worker threads, so several sessions can be busy at once.
+ * Always close the pool when it is not needed anymore.
+ *
+ * Example:
+ * const pool = await TransbasePool.create({url: "//localhost:2024/sample", user: "tbadmin", password: "admin", size: 4});
+ * const rows = await pool.query("select * from cashbook");
+ * await pool.close();
+ *********************************/
+export declare class TransbasePool {
+  /** create a pool and start connecting, await ready before the first query */
+  constructor(config: TransbasePoolConfig);
+  /** create a pool and wait until all initial connections are established */
+  static create(config: TransbasePoolConfig): Promise<TransbasePool>;
+  /** resolves when all initial connections are established */
+  readonly ready: Promise<TransbasePool>;
+  /** borrow a connection, it has to be given back with release */
+  acquire(): Promise<Transbase>;
+  /** give a connection back to the pool */
+  release(transbase: Transbase): void;
+  /** run fn with a borrowed connection, which is released when the returned promise settles */
+  withConnection<R>(fn: (transbase: Transbase) => Promise<R> | R): Promise<R>;
+  /** execute a query on the next idle connection and get all selected rows or the number of affected records */
+  query<T = unknown>(
+    sql: string,
+    params?: Params,
+    options?: { typeCast?: boolean }
+  ): Promise<T extends number ? number : T[]>;
+  /** number of open, idle and waiting connections */
+  getStats(): { connections: number; idle: number; waiters: number };
+  /** close idle connections and reject waiters, busy connections are closed when released */
+  close(): Promise<void>;
+}
+
+/** hashes are Buffers or hex strings */
+type LedgerHash = Buffer | string;
+export interface AuditProof {
+  recordHash: LedgerHash;
+  ledgerHash: LedgerHash;
+  /** nodes of ledger_audit_proof ordered by level */
+  path: { hash: LedgerHash; first: boolean }[];
+}
+export interface ConsistencyProof {
+  ledgerHashOld: LedgerHash;
+  ledgerHashNew: LedgerHash;
+  /** nodes of ledger_consistency_proof ordered by new */
+  path: { hash: LedgerHash; first: boolean; old: unknown; new: unknown }[];
+}
+/** fold ledger proof paths natively, split across up to `threads` worker threads (default 4) */
+export declare const Ledger: {
+  verifyAuditProofs(proofs: AuditProof[], threads?: number): Promise<boolean[]>;
+  verifyConsistencyProofs(
+    proofs: ConsistencyProof[],
+    threads?: number
+  ): Promise<boolean[]>;
+};
+
+/** a query was cancelled because its timeout passed */
+export declare class TimeoutError extends Error {
+  constructor(message: string, timeout: number);
+  name: "TimeoutError";
+  code: "ETIMEDOUT";
+  /** milliseconds */
+  timeout: number;
+}
+/** a query was cancelled by its AbortSignal */
+export declare class AbortError extends Error {
+  constructor(message?: string);
+  name: "AbortError";
+  code: "ABORT_ERR";
+}
+
+/** process-wide pools of sessions, shared by the clients of all worker threads */
+export declare const SharedPool: {
+  /** register a pool, no session is logged in until one is borrowed */
+  register(name: string, config: SharedPoolConfig): void;
+  /** remove a pool, borrowed sessions are closed when they are given back */
+  unregister(name: string): boolean;
+  getStats(name: string): SharedPoolStats | undefined;
+};
+/** the ArrayBuffers of a ResultSet.fetchColumns batch, to transfer it with postMessage */
+export declare function getTransferList(batch: ColumnBatch): ArrayBuffer[];
+
 export type SqlType = {
   BOOL: number;
   TINYINT: number;
@@ -1,48 +1,166 @@
-const { TCI, Attribute, State, SqlType } = require("bindings")("tci");
+const {
+  TCI,
+  Environment,
+  Attribute,
+  State,
+  SqlType,
+  Cursor: NativeCursor,
+  Ledger,
+  SharedPool,
+  setErrorClasses,
+} = require("bindings")({
+  bindings: "tci",
+  // another build of the addon, e.g. bench/ linked against the mock tci library
+  module_root: process.env.TRANSBASE_BINDING_ROOT,
+});
+const { Readable } = require("stream");
+const { performance } = require("perf_hooks");
+const crypto = require("crypto");
+
+/** diagnostics channel publishing an event per query, if supported by the node version */
+let queryChannel;
+try {
+  queryChannel = require("diagnostics_channel").channel("transbase:query");
+} catch {}
+
+/** number of rows the first native call of next() reads ahead, doubled for every further batch */
+const NEXT_BATCH_SIZE = 16;
+/** number of rows toArray() converts with a single native call, doubled for every further batch */
+const TO_ARRAY_BATCH_SIZE = 1000;
+/** upper bound of the adaptive fetch size of long scans */
+const MAX_BATCH_SIZE = 8192;
+/** number of rows a stream buffers by default */
+const STREAM_HIGH_WATER_MARK = 1000;
+/** default chunk size of chunked value reads */
+const VALUE_CHUNK_SIZE = 64 * 1024;
+
+/** a query was cancelled because its timeout passed, the timeout is in milliseconds */
+class TimeoutError extends Error {
+  constructor(message, timeout) {
+    super(message);
+    this.name = "TimeoutError";
+    this.code = "ETIMEDOUT";
+    this.timeout = timeout;
+  }
+}
+
+/** a query was cancelled by its AbortSignal */
+class AbortError extends Error {
+  constructor(message = "query aborted") {
+    super(message);
+    this.name = "AbortError";
+    this.code = "ABORT_ERR";
+  }
+}
+
+// thrown by the native side for cancelled calls, it sets name and code of plain errors otherwise
+setErrorClasses?.(TimeoutError, AbortError);
 
 /**********************************
  * RESULT SET
  * to fetch next rows sequentially or get all with toArray convenience
  *********************************/
 class ResultSet {
-  constructor(tci) {
+  constructor(tci, options, cached) {
     this.tci = tci;
+    this.typeCast = options?.typeCast;
+    this.lazy = options?.lazy;
+    this.fetchSize = options?.fetchSize ?? "adaptive";
+    // rows read ahead by next()
+    this._rows = [];
+    this._rowIndex = 0;
+    // number of rows the next adaptive fetch reads at least
+    this._batchSize = 0;
+    // rows of the result cache, served before any further row is fetched
+    this._cached = cached;
+    this._cachedIndex = 0;
 
-    // retrieve column infos
-    const colCount = Attributes.getColumnCount(this.tci);
-    this.colInfos = [];
-    for (let col = 1; col <= colCount; col++) {
-      this.colInfos.push({
-        col,
-        name: Attributes.getColumnName(this.tci, col),
-        type: Attributes.getColumnType(this.tci, col),
-        get typeName() {
-          return (Object.entries(SqlType).find(
-            ([_, value]) => value === this.type
-          ) || ["TYPE(" + this.type + ")"])[0];
-        },
-      });
-    }
+    // column infos, described natively once per cached statement
+    this.colInfos = cached ? cached.columns : this.tci.describe();
   }
 
-  /** fetch and get data of next row. Returns undefined if no data is found */
+  /**
+   * fetch and get data of next row. Returns undefined if no data is found.
+   * Rows are read ahead in batches, so the low-level fetch/readValue api throws once next() has read rows.
+   */
   next() {
-    if (this.tci.fetch()) {
-      let row = {};
-      for (let { col, name, type } of this.colInfos) {
-        row[name] = this.tci.getValue(col, type);
+    if (this._rowIndex >= this._rows.length) {
+      if (!this._canFetch()) {
+        return;
       }
-      return row;
+      this._rows = this._fetchRows(this._nextBatchSize(NEXT_BATCH_SIZE));
+      this._rowIndex = 0;
     }
+    return this._rows[this._rowIndex++];
+  }
+
+  /** like next but the row is fetched on a worker thread without blocking the event loop */
+  async nextAsync() {
+    if (this._rowIndex >= this._rows.length) {
+      if (!this._canFetch()) {
+        return;
+      }
+      const batchSize = this._nextBatchSize(NEXT_BATCH_SIZE);
+      this._rows = await this._fetchRowsAsync(batchSize);
+      this._rowIndex = 0;
+    }
+    return this._rows[this._rowIndex++];
+  }
+
+  /** fetch up to maxRows rows as object array on a worker thread. Returns an empty array at the end. */
+  fetchRowsAsync(maxRows = TO_ARRAY_BATCH_SIZE) {
+    if (this._hasCachedRows()) {
+      return Promise.resolve(this._fetchCachedRows(maxRows));
+    }
+    return this.tci.fetchRowsAsync(maxRows, this.typeCast);
+  }
+
+  /**
+   * fetch up to maxRows rows in columnar layout. Numeric columns are returned as typed arrays,
+   * strings and binaries as offsets into a data buffer. Returns an empty batch (length 0) at the end.
+   */
+  fetchColumns(maxRows = TO_ARRAY_BATCH_SIZE) {
+    return this._cursor("fetchColumns").fetchColumns(maxRows, this.typeCast);
+  }
+
+  /** same as fetchColumns but the rows are fetched on a worker thread */
+  async fetchColumnsAsync(maxRows = TO_ARRAY_BATCH_SIZE) {
+    const tci = this._cursor("fetchColumnsAsync");
+    return tci.fetchColumnsAsync(maxRows, this.typeCast);
+  }
+
+  /**
+   * fetch up to maxRows rows and compute their sha-256 ledger record hashes natively,
+   * @see TransbaseLedger.hashLedgerRecord of example/transbase-ledger.js
+   * @returns an array of 32 byte Buffers, empty at the end
+   */
+  hashLedgerRecords(maxRows = TO_ARRAY_BATCH_SIZE) {
+    return this._cursor("hashLedgerRecords").hashLedgerRecords(maxRows);
+  }
+
+  /** same as hashLedgerRecords but the rows are fetched and hashed on a worker thread */
+  async hashLedgerRecordsAsync(maxRows = TO_ARRAY_BATCH_SIZE) {
+    const tci = this._cursor("hashLedgerRecordsAsync");
+    return tci.hashLedgerRecordsAsync(maxRows);
+  }
+
+  /** the sha-256 ledger record hash of the current row */
+  hashLedgerRecord() {
+    return this._cursor("hashLedgerRecord").hashLedgerRecord();
   }
 
   fetch() {
-    return this.tci.fetch();
+    return this._cursor("fetch").fetch();
+  }
+
+  async fetchAsync() {
+    return this._cursor("fetchAsync").fetchAsync();
   }
 
   readValue(colNoOrName, typeCast = true) {
+    const tci = this._cursor("readValue");
     const col = this.getColumn(colNoOrName);
-    return this.tci.getValue(col.col, col.type, typeCast);
+    return tci.getValue(col.col, col.type, typeCast);
   }
 
   readValueAsString(colNoOrName) {
@@ -50,29 +168,104 @@ class ResultSet {
   }
 
   readValueAsBuffer(colNoOrName, size = 1024 * 1024) {
+    const tci = this._cursor("readValueAsBuffer");
+    const col = this.getColumn(colNoOrName);
+    return {
+      data: tci.getValueAsBuffer(col.col, size),
+      hasMore: tci.getState() == State.DATA_TRUNCATION,
+    };
+  }
+
+  /**
+   * read the next chunk of a (large) value into the given buffer in place
+   * @returns the number of bytes read, null if the value IS NULL
+   */
+  readValueInto(colNoOrName, buffer) {
+    const tci = this._cursor("readValueInto");
     const col = this.getColumn(colNoOrName);
+    const bytes = tci.getValueInto(col.col, buffer);
     return {
-      data: this.tci.getValueAsBuffer(col.col, size),
-      hasMore: this.tci.getState() == State.DATA_TRUNCATION,
+      bytes,
+      hasMore: bytes !== null && tci.getState() == State.DATA_TRUNCATION,
     };
   }
 
+  /**
+   * read a (large) value, e.g. of a blob or clob column, chunk by chunk on a worker thread.
+   * All chunks are read into one reused buffer, a chunk is only valid until the next one is read.
+   * @param options optional {chunkSize = 64KiB, buffer} to read into a buffer of the caller
+   */
+  async *readValueChunks(colNoOrName, options) {
+    const tci = this._cursor("readValueChunks");
+    const col = this.getColumn(colNoOrName);
+    const buffer =
+      options?.buffer ??
+      Buffer.allocUnsafe(options?.chunkSize ?? VALUE_CHUNK_SIZE);
+    let hasMore = true;
+    while (hasMore) {
+      const bytes = await tci.getValueIntoAsync(col.col, buffer);
+      if (bytes === null) {
+        return;
+      }
+      hasMore = tci.getState() == State.DATA_TRUNCATION;
+      yield buffer.subarray(0, bytes);
+    }
+  }
+
+  /** readable stream of a (large) value, every chunk is read into its own buffer on a worker thread */
+  createValueStream(colNoOrName, options) {
+    const tci = this._cursor("createValueStream");
+    const col = this.getColumn(colNoOrName);
+    const chunkSize = options?.chunkSize ?? VALUE_CHUNK_SIZE;
+    return new Readable({
+      async read() {
+        try {
+          const buffer = Buffer.allocUnsafe(chunkSize);
+          const bytes = await tci.getValueIntoAsync(col.col, buffer);
+          if (bytes) {
+            this.push(buffer.subarray(0, bytes));
+          }
+          if (bytes === null || tci.getState() != State.DATA_TRUNCATION) {
+            this.push(null);
+          }
+        } catch (error) {
+          this.destroy(error);
+        }
+      },
+    });
+  }
+
   isNull(colNoOrName) {
-    return this.tci.getIsNull(this.getColumn(colNoOrName).col);
+    const tci = this._cursor("isNull");
+    return tci.getIsNull(this.getColumn(colNoOrName).col);
   }
 
   /** false if there is no further row to fetch (NO_DATA_FOUND) */
   hasNext() {
-    return this.tci.getState() == State.SUCCESS;
+    return this._rowIndex < this._rows.length || this._canFetch();
   }
 
   /** convenience to get all rows as object array */
   toArray() {
-    const result = [];
-    let nextRow = this.next();
-    while (nextRow) {
-      result.push(nextRow);
-      nextRow = this.next();
+    const result = this._rows.slice(this._rowIndex);
+    this._rows = [];
+    this._rowIndex = 0;
+    while (this._canFetch()) {
+      const rows = this._fetchRows(this._nextBatchSize(TO_ARRAY_BATCH_SIZE));
+      rows.forEach((row) => result.push(row));
+    }
+    return result;
+  }
+
+  /** convenience to get all rows as object array, fetching on a worker thread */
+  async toArrayAsync() {
+    const result = this._rows.slice(this._rowIndex);
+    this._rows = [];
+    this._rowIndex = 0;
+    while (this._canFetch()) {
+      const batchSize = this._nextBatchSize(TO_ARRAY_BATCH_SIZE);
+      const rows = await this._fetchRowsAsync(batchSize);
+      rows.forEach((row) => result.push(row));
     }
     return result;
   }
@@ -81,10 +274,533 @@ class ResultSet {
     return this.colInfos;
   }
 
+  /**
+   * number of rows to fetch with the next native call. A fixed fetchSize is used as is,
+   * the adaptive one starts small for point queries and doubles per batch for long scans.
+   */
+  _nextBatchSize(initial) {
+    if (this.fetchSize !== "adaptive") {
+      return this.fetchSize;
+    }
+    const batchSize = Math.max(this._batchSize, initial);
+    this._batchSize = Math.min(batchSize * 2, MAX_BATCH_SIZE);
+    return batchSize;
+  }
+
+  /** next batch of row objects, lazy rows if the result set is lazy */
+  _fetchRows(maxRows) {
+    if (this._hasCachedRows()) {
+      return this._fetchCachedRows(maxRows);
+    }
+    if (!this._isLazy()) {
+      return this.tci.fetchRows(maxRows, this.typeCast);
+    }
+    return this._toLazyRows(this.tci.fetchLazy(maxRows, this.typeCast));
+  }
+
+  async _fetchRowsAsync(maxRows) {
+    if (!this._isLazy() || this._hasCachedRows()) {
+      return this.fetchRowsAsync(maxRows);
+    }
+    const batch = await this.tci.fetchLazyAsync(maxRows, this.typeCast);
+    return this._toLazyRows(batch);
+  }
+
+  /**
+   * rows of results with BLOB or CLOB columns are fetched eagerly although the result set is lazy,
+   * as a lob can only be read while the cursor is on its row
+   */
+  _isLazy() {
+    return this.lazy && !getLazyRowClass(this.colInfos).hasLobs;
+  }
+
+  /** false if all rows are read, from the result cache or the result set */
+  _canFetch() {
+    if (this._hasCachedRows() || this._cached?.complete) {
+      return this._hasCachedRows();
+    }
+    return this.tci.getState() == State.SUCCESS;
+  }
+
+  /** the native cursor of the low-level api, which has no current row while rows are served from the result cache or read ahead by next */
+  _cursor(method) {
+    if (this._hasCachedRows() || this._cached?.complete) {
+      throw Error(
+        `${method} can not read a result served from the result cache, use next or toArray, or query without the cache option`
+      );
+    }
+    if (this._rows.length > 0) {
+      throw Error(
+        `${method} can not read the current row after next read rows ahead, use either next/toArray or the low-level fetch api`
+      );
+    }
+    return this.tci;
+  }
+
+  _hasCachedRows() {
+    return this._cachedIndex < (this._cached?.length ?? 0);
+  }
+
+  /** cached rows are plain objects, also for lazy result sets */
+  _fetchCachedRows(maxRows) {
+    const rows = this.tci.getCachedRows(
+      this._cached.entry,
+      this._cachedIndex,
+      maxRows
+    );
+    this._cachedIndex += rows.length;
+    return rows;
+  }
+
+  /**
+   * fetch the rows into the result cache, they are served from there.
+   * Only the rows of results up to maxRows rows are cached, the others are fetched as usual afterwards.
+   */
+  _fillCache(key, tables) {
+    this._cached = this.tci.cacheResult(key, tables, this.typeCast);
+  }
+
+  async _fillCacheAsync(key, tables) {
+    this._cached = await this.tci.cacheResultAsync(key, tables, this.typeCast);
+  }
+
+  _toLazyRows(batch) {
+    const LazyRow = getLazyRowClass(this.colInfos);
+    const rows = new Array(batch.length);
+    for (let i = 0; i < batch.length; i++) {
+      rows[i] = new LazyRow(this, batch.columns, i);
+    }
+    return rows;
+  }
+
   getColumn(colNoOrName) {
     return typeof colNoOrName === "number"
       ? this.colInfos[colNoOrName - 1]
-      : this.colInfos.find((it) => it.name === colNoOrName);
+      : getColumnsByName(this.colInfos).get(colNoOrName);
+  }
+}
+
+/**
+ * class of the lazy rows of a result shape, generated once per (cached) description.
+ * A column is converted from the fetched native values on first access and memoized.
+ */
+const lazyRowClasses = new WeakMap();
+const RESULT_SET = Symbol("resultSet");
+const COLUMNS = Symbol("columns");
+const INDEX = Symbol("index");
+const VALUES = Symbol("values");
+function getLazyRowClass(colInfos) {
+  let LazyRow = lazyRowClasses.get(colInfos);
+  if (LazyRow) {
+    return LazyRow;
+  }
+  LazyRow = class {
+    constructor(resultSet, columns, index) {
+      this[RESULT_SET] = resultSet;
+      this[COLUMNS] = columns;
+      this[INDEX] = index;
+      this[VALUES] = undefined;
+    }
+
+    /** all columns as plain object, used by JSON.stringify */
+    toJSON() {
+      const row = {};
+      for (const colInfo of colInfos) {
+        row[colInfo.name] = this[colInfo.name];
+      }
+      return row;
+    }
+  };
+  // results with lobs are not fetched as lazy rows, @see ResultSet._isLazy
+  LazyRow.hasLobs = colInfos.some(
+    (colInfo) => colInfo.type === SqlType.BLOB || colInfo.type === SqlType.CLOB
+  );
+  colInfos.forEach((colInfo, index) => {
+    if (Object.prototype.hasOwnProperty.call(LazyRow.prototype, colInfo.name)) {
+      return; // of equally named columns the first one wins, as by getColumnsByName
+    }
+    Object.defineProperty(LazyRow.prototype, colInfo.name, {
+      enumerable: true,
+      get() {
+        if (!this[VALUES]) {
+          this[VALUES] = new Array(colInfos.length);
+        }
+        const values = this[VALUES];
+        if (!(index in values)) {
+          const tci = this[RESULT_SET].tci;
+          values[index] = tci.getLazyValue(this[COLUMNS], this[INDEX], index);
+        }
+        return values[index];
+      },
+    });
+  });
+  lazyRowClasses.set(colInfos, LazyRow);
+  return LazyRow;
+}
+
+/**
+ * parameters as a json string with typed buffers, dates and bigints and sorted names,
+ * undefined if a parameter is streamed and can not be part of a result cache key
+ */
+function normalizeParameters(parameters) {
+  if (!parameters) {
+    return "";
+  }
+  const entries = Array.isArray(parameters)
+    ? parameters.map((value, index) => [index, value])
+    : Object.entries(parameters).sort(([a], [b]) => (a < b ? -1 : a > b));
+  const normalized = [];
+  for (const [key, value] of entries) {
+    if (Buffer.isBuffer(value)) {
+      normalized.push([key, { buffer: value.toString("base64") }]);
+    } else if (value instanceof Date) {
+      normalized.push([key, { date: value.toISOString() }]);
+    } else if (typeof value === "bigint") {
+      normalized.push([key, { bigint: String(value) }]);
+    } else if (value !== null && typeof value === "object") {
+      return undefined;
+    } else {
+      normalized.push([key, value ?? null]);
+    }
+  }
+  return JSON.stringify(normalized);
+}
+
+/** words ending a list of tables */
+const CLAUSE_KEYWORDS = new Set([
+  ...["where", "group", "order", "having", "union", "intersect", "except"],
+  ...["join", "inner", "left", "right", "full", "outer", "cross", "natural"],
+  ...["on", "using", "set", "values", "select", "first", "limit", "for"],
+]);
+
+/** lower case name of a (schema qualified, quoted) table without schema and quotes, as in referencedTables */
+function tableName(table) {
+  return table
+    .toLowerCase()
+    .match(/(?:"[^"]*"|[^."]+)$/)[0]
+    .replace(/"/g, "");
+}
+
+/**
+ * lower case names of the tables a statement reads or writes, without schema and quotes.
+ * Empty if none is found, the result cache treats that as all tables.
+ */
+function referencedTables(sql) {
+  const words =
+    sql
+      .replace(/'(?:[^']|'')*'/g, "''")
+      .toLowerCase()
+      .match(/(?:"[^"]*"|[\w$]+)(?:\.(?:"[^"]*"|[\w$]+))*|[,(]/g) ?? [];
+  const isName = (word) => word != null && /^["\w]/.test(word);
+  const tables = new Set();
+  for (let i = 0; i < words.length; i++) {
+    if (!["from", "join", "into", "update"].includes(words[i])) {
+      continue;
+    }
+    // a comma separated list of tables with optional aliases
+    while (isName(words[i + 1]) && !CLAUSE_KEYWORDS.has(words[i + 1])) {
+      const name = words[++i].match(/(?:"[^"]*"|[^."]+)$/)[0];
+      tables.add(name.replace(/"/g, ""));
+      if (words[i + 1] === "as") {
+        i++;
+      }
+      if (isName(words[i + 1]) && !CLAUSE_KEYWORDS.has(words[i + 1])) {
+        i++; // alias
+      }
+      if (words[i + 1] !== ",") {
+        break;
+      }
+      i++;
+    }
+  }
+  return [...tables];
+}
+
+/**
+ * an abort before the execution is set up natively. Once it executed, an abort fails only the native calls still
+ * running or to come, so a write that completed is never reported as aborted.
+ */
+function checkAborted(options) {
+  if (options?.signal?.aborted) {
+    throw new AbortError();
+  }
+}
+
+function checkFetchSize(fetchSize) {
+  if (
+    fetchSize != null &&
+    fetchSize !== "adaptive" &&
+    !(Number.isInteger(fetchSize) && fetchSize > 0)
+  ) {
+    throw RangeError('fetchSize must be a positive integer or "adaptive"');
+  }
+  return fetchSize;
+}
+
+/** name index of column infos, built once per (cached) description. Of equally named columns the first one wins. */
+const columnsByName = new WeakMap();
+function getColumnsByName(colInfos) {
+  let index = columnsByName.get(colInfos);
+  if (!index) {
+    index = new Map();
+    for (const colInfo of colInfos) {
+      if (!index.has(colInfo.name)) {
+        index.set(colInfo.name, colInfo);
+      }
+    }
+    columnsByName.set(colInfos, index);
+  }
+  return index;
+}
+
+/**********************************
+ * RESULT STREAM
+ * a readable object stream of the rows (or columnar batches) of a query.
+ * While the consumer processes a batch, the next one is already fetched on a worker thread.
+ *********************************/
+class ResultStream extends Readable {
+  constructor(transbase, sql, parameters, options = {}) {
+    const columnar = !!options.columnar;
+    const highWaterMark =
+      options.highWaterMark ?? (columnar ? 2 : STREAM_HIGH_WATER_MARK);
+    super({ objectMode: true, highWaterMark });
+    this.transbase = transbase;
+    this.sql = sql;
+    this.parameters = parameters;
+    this.typeCast = options.typeCast;
+    this.timeout = options.timeout;
+    this.signal = options.signal;
+    this.columnar = columnar;
+    this.batchSize =
+      options.batchSize ?? (columnar ? TO_ARRAY_BATCH_SIZE : highWaterMark);
+    this._resultSet = null;
+    // the batch fetched ahead and the native operation currently running
+    this._prefetch = null;
+    this._pending = null;
+    if (this.signal) {
+      const abort = () => this.destroy(new AbortError());
+      this.signal.addEventListener("abort", abort, { once: true });
+      this.once("close", () =>
+        this.signal.removeEventListener("abort", abort)
+      );
+    }
+  }
+
+  async _read() {
+    try {
+      if (!this._resultSet) {
+        const result = await this._run(
+          this.transbase.queryAsync(this.sql, this.parameters, {
+            typeCast: this.typeCast,
+            timeout: this.timeout,
+            signal: this.signal,
+          })
+        );
+        if (!(result instanceof ResultSet)) {
+          throw Error("only select queries can be streamed");
+        }
+        this._resultSet = result;
+      }
+      const batch = await (this._prefetch ?? this._fetchBatch());
+      this._prefetch = null;
+      if (batch.length === 0) {
+        this.push(null);
+        return;
+      }
+      if (!this.destroyed) {
+        this._prefetch = this._fetchBatch();
+      }
+      if (this.columnar) {
+        this.push(batch);
+      } else {
+        batch.forEach((row) => this.push(row));
+      }
+    } catch (error) {
+      this.destroy(error);
+    }
+  }
+
+  _fetchBatch() {
+    if (!this._resultSet.hasNext()) {
+      return Promise.resolve([]);
+    }
+    return this._run(
+      this.columnar
+        ? this._resultSet.fetchColumnsAsync(this.batchSize)
+        : this._resultSet.fetchRowsAsync(this.batchSize)
+    );
+  }
+
+  /** keep track of a native operation, errors are reported when the promise is awaited */
+  _run(promise) {
+    this._pending = promise;
+    promise.catch(() => {});
+    return promise;
+  }
+
+  _destroy(error, callback) {
+    // the client can not be used until a running fetch is done
+    Promise.resolve(this._pending)
+      .catch(() => {})
+      .then(() => callback(error));
+  }
+}
+
+/**********************************
+ * PREPARED STATEMENT
+ * a statement that is prepared once and executed with different parameters.
+ * Prepared statements are kept in the statement cache of the client.
+ *********************************/
+class PreparedStatement {
+  constructor(transbase, sql) {
+    this.transbase = transbase;
+    this.sql = sql;
+    transbase.tci.prepare(sql);
+  }
+
+  /**
+   * execute the statement
+   * @param params optional query paramters as an array of positional parameters or a key-value object for named parameters
+   * @returns a ResultSet if the query has data to select or the number of affected records for insert,update statements
+   */
+  query(parameters = [], options) {
+    const { transbase, sql } = this;
+    return transbase._trace(sql, parameters, () =>
+      transbase._withResultCache(sql, parameters, options, () =>
+        transbase._queryPrepared(sql, parameters, options)
+      )
+    );
+  }
+
+  /** same as query but prepared and executed on a worker thread */
+  queryAsync(parameters = [], options) {
+    const { transbase, sql } = this;
+    return transbase._trace(sql, parameters, () =>
+      transbase._withResultCacheAsync(sql, parameters, options, () =>
+        transbase._queryPreparedAsync(sql, parameters, options)
+      )
+    );
+  }
+}
+
+/**********************************
+ * CURSOR
+ * a cursor has its own native statement and result set, so its result set stays open
+ * while other queries run on the same connection, e.g. lookups while iterating a driving query.
+ * Only one native call runs per connection at a time, so do not await async calls of a cursor and
+ * of its connection concurrently.
+ *
+ * Example:
+ * const cursor = transbase.openCursor();
+ * const resultSet = cursor.query("select * from cashbook");
+ * for (let row; (row = resultSet.next()); ) {
+ *   transbase.query("select * from account where id = ?", [row.account]);
+ * }
+ * cursor.close();
+ *********************************/
+class Cursor {
+  constructor(transbase) {
+    this.transbase = transbase;
+    this._native = new NativeCursor();
+    transbase.tci.openCursor(this._native);
+    // the client with every native call redirected to the handles of this cursor
+    this._session = Object.create(transbase, {
+      tci: { value: selectCursor(transbase.tci, this._native) },
+      _unlisten: { value: undefined, writable: true },
+    });
+  }
+
+  /** same as Transbase.query but run on the cursor */
+  query(sql, parameters, options) {
+    return this._session.query(sql, parameters, options);
+  }
+
+  /** same as Transbase.queryAsync but run on the cursor */
+  queryAsync(sql, parameters, options) {
+    return this._session.queryAsync(sql, parameters, options);
+  }
+
+  /** same as Transbase.prepare but prepared on the cursor */
+  prepare(sql) {
+    return new PreparedStatement(this._session, sql);
+  }
+
+  /** close the result set and give the handles back to the connection, also done when garbage collected */
+  close() {
+    this.transbase.tci.closeCursor(this._native);
+  }
+}
+
+/** a proxy of the native client selecting the cursor's handles for every call */
+function selectCursor(tci, cursor) {
+  const methods = new Map();
+  return new Proxy(tci, {
+    get(target, name) {
+      const value = target[name];
+      if (typeof value !== "function") {
+        return value;
+      }
+      if (name === "cancel") {
+        // cancels the running call, whichever handles it runs on
+        return value.bind(target);
+      }
+      if (!methods.has(name)) {
+        // the native side deselects the cursor when an async call completes
+        const async = name.endsWith("Async");
+        methods.set(name, (...args) => {
+          target.useCursor(cursor);
+          let started = false;
+          try {
+            const result = value.apply(target, args);
+            started = async;
+            return result;
+          } finally {
+            if (!started) {
+              target.useCursor();
+            }
+          }
+        });
+      }
+      return methods.get(name);
+    },
+  });
+}
+
+/**
+ * borrow calls of this thread waiting for a session of a SharedPool, by pool name.
+ * A session given back by a client of this thread wakes the first one, the others retry after SHARED_POOL_RETRY
+ * milliseconds, as sessions given back by other threads wake no waiter.
+ */
+const sharedPoolWaiters = new Map();
+const SHARED_POOL_RETRY = 50;
+
+/** wait until a client of this thread gives back a session of the pool, or ms milliseconds passed */
+function waitForSharedSession(name, ms) {
+  return new Promise((resolve) => {
+    const waiters = sharedPoolWaiters.get(name) ?? [];
+    sharedPoolWaiters.set(name, waiters);
+    const timer = setTimeout(() => {
+      waiters.splice(waiters.indexOf(wake), 1);
+      if (!waiters.length) {
+        sharedPoolWaiters.delete(name);
+      }
+      resolve();
+    }, ms);
+    const wake = () => {
+      clearTimeout(timer);
+      resolve();
+    };
+    waiters.push(wake);
+  });
+}
+
+function wakeSharedSessionWaiter(name) {
+  const waiters = sharedPoolWaiters.get(name);
+  if (waiters) {
+    waiters.shift()();
+    if (!waiters.length) {
+      sharedPoolWaiters.delete(name);
+    }
   }
 }
 
@@ -103,13 +819,68 @@ class Transbase {
    * create a new transbase database client
    * @param config defining the database url connecting to, logging in with the given user and password
    **/
-  constructor(config) {
+  constructor(config, connect = true) {
     this._connectionUrl = config?.url;
     this.tci = new TCI();
     if (config && config.typeCast != null) {
       this.setTypeCast(config.typeCast);
     }
-    this.tci.connect(config);
+    if (config && config.statementCacheSize != null) {
+      this.tci.setStatementCacheSize(config.statementCacheSize);
+    }
+    if (config?.stats) {
+      this.tci.setStatsEnabled(true);
+    }
+    if (config?.internStrings) {
+      this.tci.setInternStrings(true);
+    }
+    if (config?.dateCast) {
+      this.tci.setDateCast(config.dateCast);
+    }
+    if (config?.resultCache) {
+      this.tci.setResultCache(config.resultCache);
+    }
+    this.setFetchSize(config?.fetchSize);
+    if (connect) {
+      this.tci.connect(config);
+    }
+  }
+
+  /**
+   * create a new transbase database client, connecting and logging in on a worker thread
+   * @param config defining the database url connecting to, logging in with the given user and password
+   * @returns a promise of the connected client
+   **/
+  static async connect(config) {
+    const transbase = new Transbase(config, false);
+    await transbase.tci.connectAsync(config);
+    return transbase;
+  }
+
+  /**
+   * create a new transbase database client on a session of a SharedPool instead of logging in.
+   * The pool is process-wide, so clients of every worker thread can borrow from it, close gives the session back.
+   * @param name the name the pool is registered with @see SharedPool.register
+   * @param config client options as for the constructor, the connection ones are taken from the pool,
+   * with additional acquireTimeout = 30000 milliseconds to wait while all sessions are borrowed.
+   * The wait is on the event loop, no worker thread is blocked while all sessions are borrowed.
+   * @returns a promise of the connected client
+   **/
+  static async borrow(name, config) {
+    const transbase = new Transbase(config, false);
+    const acquireTimeout = config?.acquireTimeout ?? 30000;
+    const deadline = Date.now() + acquireTimeout;
+    while (!(await transbase.tci.borrowAsync(name))) {
+      const wait = deadline - Date.now();
+      if (wait <= 0) {
+        throw Error(
+          `acquire timeout after ${acquireTimeout}ms, all shared sessions of ${name} are borrowed`
+        );
+      }
+      await waitForSharedSession(name, Math.min(wait, SHARED_POOL_RETRY));
+    }
+    transbase._sharedPool = name;
+    return transbase;
   }
 
   getVersionInfo() {
@@ -132,6 +903,12 @@ class Transbase {
     this.tci.setTypeCast(value);
   }
 
+  /** set the number of rows fetched per native call, a positive number or "adaptive" */
+  setFetchSize(value = "adaptive") {
+    checkFetchSize(value);
+    this.fetchSize = value;
+  }
+
   /**
    * execute a query directly in auto-commit mode
    * @param sql the sql query to execute
@@ -139,42 +916,394 @@ class Transbase {
    * @returns a ResetSet if the query has data to select or the number of affected records for insert,update statements
    **/
   query(sql, parameters, options) {
-    try {
-      if (options?.typeCast != null) {
-        this.tci.setTypeCast(options.typeCast);
-      }
+    return this._trace(sql, parameters, () =>
+      this._withResultCache(sql, parameters, options, () => {
+        if (!parameters) {
+          this.tci.executeDirect(sql, this._limit(options));
+          return this._getResult(options, sql);
+        }
+        return this._queryPrepared(sql, parameters, options);
+      })
+    );
+  }
+
+  _queryPrepared(sql, parameters, options) {
+    const timeout = this._limit(options);
+    this.tci.prepare(sql); // reused from the statement cache
+    this._setParams(parameters);
+    this.tci.execute(timeout);
+    return this._getResult(options, sql);
+  }
+
+  /**
+   * same as query, but the statement is prepared and executed on a worker thread
+   * without blocking the event loop. Only one async operation may run per client at a time.
+   * @returns a promise of a ResultSet or the number of affected records
+   **/
+  queryAsync(sql, parameters, options) {
+    return this._trace(sql, parameters, () =>
+      this._withResultCacheAsync(sql, parameters, options, async () => {
+        if (!parameters) {
+          await this.tci.executeDirectAsync(sql, this._limit(options));
+          return this._getResult(options, sql);
+        }
+        return this._queryPreparedAsync(sql, parameters, options);
+      })
+    );
+  }
+
+  /**
+   * serve a select from the result cache if options.cache is set, otherwise run it and cache its rows.
+   * Results are cached per client, writes of the client to a referenced table invalidate them.
+   */
+  _withResultCache(sql, parameters, options, query) {
+    const key =
+      options?.cache && this._resultCacheKey(sql, parameters, options);
+    if (!key) {
+      return query();
+    }
+    const cached = this.tci.getCachedResult(key);
+    if (cached) {
+      return new ResultSet(this.tci, this._resultSetOptions(options), cached);
+    }
+    const result = query();
+    if (result instanceof ResultSet) {
+      result._fillCache(key, referencedTables(sql));
+    }
+    return result;
+  }
+
+  async _withResultCacheAsync(sql, parameters, options, query) {
+    const key =
+      options?.cache && this._resultCacheKey(sql, parameters, options);
+    if (!key) {
+      return query();
+    }
+    const cached = this.tci.getCachedResult(key);
+    if (cached) {
+      return new ResultSet(this.tci, this._resultSetOptions(options), cached);
+    }
+    const result = await query();
+    if (result instanceof ResultSet) {
+      await result._fillCacheAsync(key, referencedTables(sql));
+    }
+    return result;
+  }
+
+  /** sql text, typeCast and a hash of the normalized parameters, undefined if a parameter can not be cached */
+  _resultCacheKey(sql, parameters, options) {
+    const typeCast = options?.typeCast ?? this.typeCast ?? true;
+    const normalized = normalizeParameters(parameters);
+    if (normalized === undefined) {
+      return undefined;
+    }
+    const hash = crypto
+      .createHash("sha256")
+      .update(normalized)
+      .digest("base64");
+    return `${typeCast ? 1 : 0}:${hash}:${sql}`;
+  }
+
+  /**
+   * write all rows of a select query to a file. Rows are fetched and serialized natively on a worker thread
+   * without creating js values. Datetimes are written as strings, binaries as hex.
+   * @param sql the sql query to execute
+   * @param params optional query paramters, same as for query
+   * @param options {format = "csv", path | fd, header = true, delimiter = ",", batchSize = 8192, typeCast}
+   * format is "csv", "ndjson" (a json object per line) or "arrow" (arrow ipc stream, a record batch per batchSize rows)
+   * @returns a promise of {rows, bytes} written
+   **/
+  exportQuery(sql, parameters, options) {
+    return this._trace(sql, parameters, async () => {
+      const timeout = this._limit(options);
       if (!parameters) {
-        this.tci.executeDirect(sql);
+        await this.tci.executeDirectAsync(sql, timeout);
       } else {
-        this.tci.prepare(sql); // TODO: can we call prepare everytime?
-
-        if (Array.isArray(parameters)) {
-          parameters.forEach((value, index) => this.tci.setParam(index, value));
-        } else if (typeof parameters === "object") {
-          Object.entries(parameters).forEach(([name, value]) =>
-            this.tci.setParam(name, value)
-          );
-        } else {
-          throw Error(
-            "parametrized queries must either contain an array of positional parameters (?) or an key-value object of named parameters (:param) as second argument"
-          );
-        }
-        this.tci.execute();
+        await this.tci.prepareAsync(sql);
+        await this._setParamsAsync(parameters);
+        checkAborted(options);
+        await this.tci.executeAsync(timeout);
       }
-      switch (this.tci.getQueryType()) {
-        case "UPDATE":
-          return Attributes.getRecordsTouched(this.tci);
-        case "SELECT":
-          return new ResultSet(this.tci);
-        case "SCHEMA":
-        default:
-          return this.tci.getState();
+      if (this.tci.getQueryType() !== "SELECT") {
+        throw Error("exportQuery requires a select query");
       }
+      return this.tci.exportAsync(options ?? {});
+    });
+  }
+
+  /**
+   * run a query and publish {sql, parameters, duration, result | error} to the "transbase:query"
+   * diagnostics channel, if there are subscribers
+   */
+  _trace(sql, parameters, query) {
+    if (!queryChannel?.hasSubscribers) {
+      return query();
+    }
+    const start = performance.now();
+    const publish = (event) =>
+      queryChannel.publish({
+        sql,
+        parameters,
+        duration: performance.now() - start,
+        ...event,
+      });
+    try {
+      const result = query();
+      if (result instanceof Promise) {
+        return result.then(
+          (value) => {
+            publish({ result: value });
+            return value;
+          },
+          (error) => {
+            publish({ error });
+            throw error;
+          }
+        );
+      }
+      publish({ result });
+      return result;
+    } catch (error) {
+      publish({ error });
+      throw error;
+    }
+  }
+
+  /**
+   * stream the rows of a query. Rows are fetched in batches on a worker thread,
+   * the next batch is fetched while the current one is consumed.
+   * @param sql the sql query to execute
+   * @param params optional query paramters, same as for query
+   * @param options optional {highWaterMark = 1000, batchSize = highWaterMark, columnar = false, typeCast}.
+   * With columnar, every chunk is a batch as returned by ResultSet.fetchColumns and highWaterMark counts batches.
+   * @returns a Readable in object mode
+   **/
+  stream(sql, parameters, options) {
+    return new ResultStream(this, sql, parameters, options);
+  }
+
+  async _queryPreparedAsync(sql, parameters, options) {
+    const timeout = this._limit(options);
+    await this.tci.prepareAsync(sql);
+    await this._setParamsAsync(parameters);
+    checkAborted(options);
+    await this.tci.executeAsync(timeout);
+    return this._getResult(options, sql);
+  }
+
+  /**
+   * bound the next execution and the reading of its result set by options {timeout, signal}.
+   * An abort cancels the running native call, the listener is removed with the next query of the client.
+   * An abort before the execution begins, e.g. while it is queued, fails it before anything is executed.
+   * @returns the timeout in milliseconds for the native execution
+   */
+  _limit(options) {
+    this._unlisten?.();
+    this._unlisten = undefined;
+    this.tci.resetCancellation();
+    const signal = options?.signal;
+    if (signal) {
+      checkAborted(options);
+      const tci = this.tci;
+      const abort = () => tci.cancel();
+      signal.addEventListener("abort", abort, { once: true });
+      this._unlisten = () => signal.removeEventListener("abort", abort);
+    }
+    return options?.timeout;
+  }
+
+  /**
+   * insert the records of a csv or ndjson file into a table. The file is read, parsed and inserted natively on a worker thread,
+   * the fields are converted once by the types of the target columns. Memory use does not grow with the file size.
+   * @param table the target table
+   * @param path the file to read
+   * @param options {format = "csv", columns, header = true, delimiter = ",", batchSize = 10000, transactional = true, maxRejects = Infinity, onProgress,
+   * timeout, signal} the whole import is cancelled after timeout milliseconds or when the signal aborts
+   * columns are the target columns in field order, by default the names of the csv header or all columns of the table,
+   * names that are no plain identifiers are quoted. The table must be a plain or quoted, optionally schema qualified, name.
+   * Lines that can not be parsed, or whose values the database can not convert (sqlstate class 22), are rejected,
+   * the import fails if there are more than maxRejects.
+   * With transactional, every batchSize rows are committed in their own transaction, onProgress({rows, rejected, bytes}) is called after each.
+   * @returns a promise of {rows, rejected, rejects, bytes}, rejects are the line and error of the first 100 rejected lines.
+   * Throws the first failing insert with its `line` and the `result` so far, the rows of its batch are rolled back if transactional.
+   **/
+  async importFile(table, path, options) {
+    this._limit(options);
+    try {
+      return await this.tci.importAsync(table, path, options ?? {});
     } finally {
-      this.setTypeCast(this.typeCast);
+      this.tci.invalidateResultCache([tableName(table)]);
     }
   }
 
+  /**
+   * execute a statement once for every row of parameters in a single native call.
+   * The statement is prepared once and, if transactional, every chunk of rows is committed in its own transaction.
+   * @param sql the sql statement to execute, e.g. an insert
+   * @param rows array of positional parameter arrays or of named parameter objects, all with the names of the first
+   * @param options optional {chunkSize = 1000, transactional = true, timeout, signal},
+   * all rows are cancelled after timeout milliseconds or when the signal aborts
+   * @returns the number of affected records of every row.
+   * Throws the first failing row's error with its `index`, rows of a failed chunk are rolled back if transactional.
+   **/
+  executeBatch(sql, rows, options) {
+    this._limit(options);
+    try {
+      return this.tci.executeBatch(sql, rows, options);
+    } finally {
+      this.tci.invalidateResultCache(referencedTables(sql));
+    }
+  }
+
+  /** same as executeBatch but the statements are executed on a worker thread */
+  async executeBatchAsync(sql, rows, options) {
+    this._limit(options);
+    try {
+      return await this.tci.executeBatchAsync(sql, rows, options);
+    } finally {
+      this.tci.invalidateResultCache(referencedTables(sql));
+    }
+  }
+
+  /**
+   * execute a sequence of statements, e.g. a schema migration, in a single native call.
+   * A script text is split on its semicolons outside of literals, quoted identifiers and comments,
+   * pass an array for statements containing semicolons themselves.
+   * @param script array of sql statements or a script text
+   * @param options optional {transactional = true, stopOnError = true, timeout, signal},
+   * the script is stopped after timeout milliseconds or when the signal aborts, also without stopOnError
+   * @returns {state, type, records, ms, error} of every executed statement, state is "ok", "failed" or
+   * "rolledBack". With stopOnError the first failure is thrown with its `index` and the `results` so far,
+   * all statements are rolled back if transactional.
+   **/
+  executeScript(script, options) {
+    this._limit(options);
+    try {
+      return this.tci.executeScript(script, options);
+    } finally {
+      this.tci.invalidateResultCache(); // any table may have been changed
+    }
+  }
+
+  /** same as executeScript but the statements are executed on a worker thread */
+  async executeScriptAsync(script, options) {
+    this._limit(options);
+    try {
+      return await this.tci.executeScriptAsync(script, options);
+    } finally {
+      this.tci.invalidateResultCache();
+    }
+  }
+
+  /**
+   * prepare a statement for repeated execution with different parameters
+   * @param sql the sql query to prepare
+   * @returns a PreparedStatement
+   */
+  prepare(sql) {
+    return new PreparedStatement(this, sql);
+  }
+
+  /**
+   * open a cursor running queries on its own statement handles, so its result set stays
+   * open while other queries run on this client. Close it when done.
+   * @returns a Cursor
+   */
+  openCursor() {
+    return new Cursor(this);
+  }
+
+  /**
+   * latency histograms (count, min, max, mean, p50, p90, p99 and total in milliseconds) of prepare,
+   * execute, first row, fetch and conversion and the number of queries, rows, bytes and errors by sqlcode.
+   * Statistics are only recorded if enabled with the stats config option.
+   */
+  getStats() {
+    return this.tci.getStats();
+  }
+
+  resetStats() {
+    this.tci.resetStats();
+  }
+
+  /** hits, misses and evictions of the prepared statement cache */
+  getStatementCacheStats() {
+    return this.tci.getStatementCacheStats();
+  }
+
+  /** size, bytes, hits, misses, evictions, expirations and invalidations of the result cache */
+  getResultCacheStats() {
+    return this.tci.getResultCacheStats();
+  }
+
+  /** drop all cached results, e.g. after another client changed the data */
+  clearResultCache() {
+    this.tci.invalidateResultCache();
+  }
+
+  /** bind all parameters with a single native call */
+  _setParams(parameters) {
+    this._checkParams(parameters);
+    this.tci.setParams(parameters);
+  }
+
+  /** like _setParams, async iterable values (e.g. a Readable) are appended natively chunk by chunk */
+  async _setParamsAsync(parameters) {
+    const params = this._getParams(parameters);
+    if (!params.some(([_, value]) => value?.[Symbol.asyncIterator])) {
+      this.tci.setParams(parameters);
+      return;
+    }
+    for (const [key, value] of params) {
+      if (value?.[Symbol.asyncIterator]) {
+        for await (const chunk of value) {
+          this.tci.appendParam(key, chunk);
+        }
+        this.tci.appendParam(key, null, true);
+      } else {
+        this.tci.setParam(key, value);
+      }
+    }
+  }
+
+  _getParams(parameters) {
+    this._checkParams(parameters);
+    return Array.isArray(parameters)
+      ? parameters.map((value, index) => [index, value])
+      : Object.entries(parameters);
+  }
+
+  _checkParams(parameters) {
+    if (typeof parameters !== "object") {
+      throw Error(
+        "parametrized queries must either contain an array of positional parameters (?) or an key-value object of named parameters (:param) as second argument"
+      );
+    }
+  }
+
+  _getResult(options, sql) {
+    switch (this.tci.getQueryType()) {
+      case "UPDATE":
+        this.tci.invalidateResultCache(referencedTables(sql));
+        return Attributes.getRecordsTouched(this.tci);
+      case "SELECT":
+        return new ResultSet(this.tci, this._resultSetOptions(options));
+      case "SCHEMA":
+        this.tci.invalidateResultCache();
+        return this.tci.getState();
+      default:
+        return this.tci.getState();
+    }
+  }
+
+  _resultSetOptions(options) {
+    return {
+      typeCast: options?.typeCast ?? this.typeCast,
+      lazy: options?.lazy,
+      fetchSize: checkFetchSize(options?.fetchSize) ?? this.fetchSize,
+    };
+  }
+
   beginTransaction() {
     this.tci.beginTransaction();
   }
@@ -185,11 +1314,200 @@ class Transbase {
 
   rollback() {
     this.tci.rollback();
+    this.tci.invalidateResultCache(); // results of the transaction may have been cached
   }
 
   /** close connection and free resources */
   close() {
+    this._limit();
     this.tci.close();
+    if (this._sharedPool !== undefined) {
+      wakeSharedSessionWaiter(this._sharedPool);
+      this._sharedPool = undefined;
+    }
+  }
+}
+
+/**********************************
+ * TRANSBASE POOL
+ * a pool of connections sharing one tci environment. Queries are dispatched to idle
+ * connections and executed on worker threads, so several sessions can be busy at once.
+ * Always close the pool when it is not needed anymore.
+ *
+ * Example:
+ * const pool = await TransbasePool.create({url: "//localhost:2024/sample", user: "tbadmin", password: "admin", size: 4});
+ * const rows = await pool.query("select * from cashbook");
+ * await pool.close();
+ *********************************/
+class TransbasePool {
+  /**
+   * create a pool and start connecting, await `ready` (or use TransbasePool.create) before the first query
+   * @param config transbase client config with additional pool options
+   * {size = 4, max = size, acquireTimeout = 30000, maxWaiters = Infinity, idleTimeout = 60000}
+   **/
+  constructor(config) {
+    this.config = config;
+    this.size = config?.size ?? 4;
+    this.max = Math.max(config?.max ?? this.size, this.size);
+    this.acquireTimeout = config?.acquireTimeout ?? 30000;
+    this.maxWaiters = config?.maxWaiters ?? Infinity;
+    this.idleTimeout = config?.idleTimeout ?? 60000;
+
+    this._environment = new Environment();
+    this._connections = new Set();
+    this._idle = []; // {transbase, since} most recently released last
+    this._waiters = []; // {resolve, reject, timer}
+    this._opening = 0;
+    this._closed = false;
+
+    // connect in parallel, each login runs on its own worker thread
+    this.ready = Promise.all(
+      Array.from({ length: this.size }, () => this._open())
+    ).then(
+      (connections) => {
+        connections.forEach((transbase) => this.release(transbase));
+        return this;
+      },
+      (error) => {
+        this.close();
+        this._connections.forEach((transbase) => this._destroy(transbase));
+        throw error;
+      }
+    );
+    this._evictTimer = setInterval(
+      () => this._evictIdle(),
+      Math.max(1000, this.idleTimeout / 2)
+    );
+    this._evictTimer.unref();
+  }
+
+  /** create a pool and wait until all initial connections are established */
+  static create(config) {
+    return new TransbasePool(config).ready;
+  }
+
+  /**
+   * borrow a connection, it has to be given back with release.
+   * Waits for a connection to become idle if all max connections are in use.
+   * @returns a promise of a connected Transbase client
+   */
+  acquire() {
+    if (this._closed) {
+      return Promise.reject(new Error("pool is closed"));
+    }
+    const idle = this._idle.pop();
+    if (idle) {
+      return Promise.resolve(idle.transbase);
+    }
+    if (this._connections.size + this._opening < this.max) {
+      return this._open();
+    }
+    if (this._waiters.length >= this.maxWaiters) {
+      return Promise.reject(
+        new Error(`pool exhausted, ${this._waiters.length} waiters queued`)
+      );
+    }
+    return new Promise((resolve, reject) => {
+      const waiter = { resolve, reject };
+      waiter.timer = setTimeout(() => {
+        this._waiters.splice(this._waiters.indexOf(waiter), 1);
+        reject(new Error(`acquire timeout after ${this.acquireTimeout}ms`));
+      }, this.acquireTimeout);
+      this._waiters.push(waiter);
+    });
+  }
+
+  /** give a connection back to the pool */
+  release(transbase) {
+    if (!this._connections.has(transbase)) {
+      return;
+    }
+    if (this._closed) {
+      this._destroy(transbase);
+      return;
+    }
+    transbase._limit(); // a late abort must not cancel a query of the next borrower
+    const waiter = this._waiters.shift();
+    if (waiter) {
+      clearTimeout(waiter.timer);
+      waiter.resolve(transbase);
+    } else {
+      this._idle.push({ transbase, since: Date.now() });
+    }
+  }
+
+  /** run fn with a borrowed connection, which is released when the returned promise settles */
+  async withConnection(fn) {
+    const transbase = await this.acquire();
+    try {
+      return await fn(transbase);
+    } finally {
+      this.release(transbase);
+    }
+  }
+
+  /**
+   * execute a query on the next idle connection
+   * @returns a promise of all selected rows or the number of affected records
+   */
+  query(sql, parameters, options) {
+    return this.withConnection(async (transbase) => {
+      const result = await transbase.queryAsync(sql, parameters, options);
+      return result instanceof ResultSet ? result.toArrayAsync() : result;
+    });
+  }
+
+  /** number of open, idle and waiting connections */
+  getStats() {
+    return {
+      connections: this._connections.size,
+      idle: this._idle.length,
+      waiters: this._waiters.length,
+    };
+  }
+
+  /** close idle connections and reject waiters, busy connections are closed when released */
+  async close() {
+    this._closed = true;
+    clearInterval(this._evictTimer);
+    for (const { reject, timer } of this._waiters.splice(0)) {
+      clearTimeout(timer);
+      reject(new Error("pool is closed"));
+    }
+    this._idle.splice(0).forEach(({ transbase }) => this._destroy(transbase));
+  }
+
+  async _open() {
+    this._opening++;
+    try {
+      const transbase = new Transbase(this.config, false);
+      await transbase.tci.connectAsync(this.config, this._environment);
+      if (this._closed) {
+        transbase.close();
+        throw new Error("pool is closed");
+      }
+      this._connections.add(transbase);
+      return transbase;
+    } finally {
+      this._opening--;
+    }
+  }
+
+  _destroy(transbase) {
+    this._connections.delete(transbase);
+    transbase.close();
+  }
+
+  /** close connections above the pool size that were idle longer than idleTimeout */
+  _evictIdle() {
+    const now = Date.now();
+    while (
+      this._idle.length &&
+      this._connections.size > this.size &&
+      now - this._idle[0].since > this.idleTimeout
+    ) {
+      this._destroy(this._idle.shift().transbase);
+    }
   }
 }
 
@@ -197,9 +1515,6 @@ class Transbase {
  * TCI_RESULTSET_ATTRIBUTE Wrapper
  *********************************/
 const Attributes = {
-  getColumnCount: getAttribute(Attribute.TCI_ATTR_COLUMN_COUNT),
-  getColumnType: getAttribute(Attribute.TCI_ATTR_COLUMN_TYPE),
-  getColumnName: getAttribute(Attribute.TCI_ATTR_COLUMN_NAME, "string"),
   getRecordsTouched: getAttribute(Attribute.TCI_ATTR_RECORDS_TOUCHED),
 };
 function getAttribute(attr, as = "number") {
@@ -209,6 +1524,34 @@ function getAttribute(attr, as = "number") {
       : tci.getResultSetAttribute(attr, col);
 }
 
+/**
+ * the ArrayBuffers of a batch returned by ResultSet.fetchColumns, to transfer instead of copy it with postMessage,
+ * e.g. worker.postMessage(batch, getTransferList(batch)). The batch is unusable by the sender afterwards.
+ */
+function getTransferList(batch) {
+  const buffers = new Set();
+  for (const column of batch.columns) {
+    const { nulls, values, offsets, data } = column;
+    for (const view of [nulls, values, offsets, data]) {
+      // a view on part of a buffer, e.g. of node's buffer pool, is not transferable alone
+      if (
+        view &&
+        view.byteOffset === 0 &&
+        view.byteLength === view.buffer.byteLength
+      ) {
+        buffers.add(view.buffer);
+      }
+    }
+  }
+  return [...buffers];
+}
+
 module.exports = {
   Transbase,
+  TransbasePool,
+  Ledger,
+  SharedPool,
+  getTransferList,
+  TimeoutError,
+  AbortError,
 };